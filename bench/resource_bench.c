@@ -0,0 +1,412 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Priority inversion benchmark for shared resources
+ * @details     A low priority thread takes a shared lock and works inside the
+ *              critical section for a fixed number of dispatches. A high
+ *              priority thread then wants the same lock, while a number of
+ *              medium priority threads, which don't use the lock, keep the CPU
+ *              busy. The benchmark reports how many dispatches the high
+ *              priority thread stays blocked.
+ *
+ *              With a plain mutex the blocking grows with the medium priority
+ *              load (unbounded priority inversion). With a resource lock it
+ *              is bounded by the length of the critical section.
+ *
+ *              The nested case uses inheritance, the low priority thread also
+ *              holds an inner resource which it releases in the middle of the
+ *              critical section. The inherited priority must survive that
+ *              release, so the blocking stays bounded.
+ *
+ *              The chain case uses inheritance, too. A link thread, with
+ *              priority just above the low priority thread, holds the lock of
+ *              the high priority thread and waits on an inner resource held by
+ *              the low priority thread. The inherited priority must pass down
+ *              the whole chain of owners.
+ *
+ *              Host program, build it together with the kernel sources and
+ *              the host port, with CONFIG_SCHED_SYNC=1.
+ *
+ *              Usage: resource_bench
+ *********************************************************************//** @{ */
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "port/core.h"
+#include "sched/sched.h"
+#include "sched/sync.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define PRIORITY_LOW                    1u
+#define PRIORITY_LINK                   2u
+#define PRIORITY_MEDIUM                 5u
+#define PRIORITY_HIGH                   10u
+
+#define CRITICAL_SECTION                10u     /* Dispatches inside the lock */
+#define MEDIUM_WORK                     100u    /* Dispatches of each medium  */
+#define MEDIUM_MAX                      8u
+
+#define LOCK_MUTEX                      0
+#define LOCK_INHERIT                    1
+#define LOCK_CEILING                    2
+#define LOCK_NESTED                     3
+#define LOCK_CHAIN                      4
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+struct bench_lock
+{
+    int                         kind;
+    struct nmutex               mutex;
+    struct nresource            resource;
+    struct nresource            inner;          /* Nested and chain cases     */
+};
+
+struct bench
+{
+    struct bench_lock           lock;
+    struct nthread              low;
+    struct nthread              link;
+    struct nthread              high;
+    struct nthread              medium[MEDIUM_MAX];
+    uint32_t                    medium_work[MEDIUM_MAX];
+    uint32_t                    mediums;
+    uint32_t                    low_work;
+    bool                        low_holds;
+    bool                        link_waits;
+    uint32_t                    dispatches;
+    uint32_t                    blocked_at;
+    uint32_t                    blocked;
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static void low_run(void * arg);
+static void link_run(void * arg);
+static void medium_run(void * arg);
+static void high_run(void * arg);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static struct bench             g_bench;
+
+static const char * const       g_lock_name[] =
+{
+    "mutex",
+    "inherit",
+    "ceiling",
+    "nested",
+    "chain"
+};
+
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static void bench_lock_init(
+    struct bench_lock *         lock,
+    int                         kind)
+{
+    lock->kind = kind;
+
+    switch (kind) {
+        case LOCK_MUTEX:
+            nmutex_init(&lock->mutex);
+            break;
+        case LOCK_INHERIT:
+            nresource_init(&lock->resource, NRESOURCE_INHERIT, 0u);
+            break;
+        case LOCK_NESTED:
+        case LOCK_CHAIN:
+            nresource_init(&lock->resource, NRESOURCE_INHERIT, 0u);
+            nresource_init(&lock->inner, NRESOURCE_INHERIT, 0u);
+            break;
+        default:
+            nresource_init(&lock->resource, NRESOURCE_CEILING, PRIORITY_HIGH);
+            break;
+    }
+}
+
+
+
+static int bench_lock(
+    struct bench_lock *         lock,
+    struct nthread *            thread)
+{
+    if (lock->kind == LOCK_MUTEX) {
+        return (nmutex_lock(&lock->mutex, thread, NSYNC_WAIT_FOREVER));
+    } else {
+        return (nresource_lock(&lock->resource, thread, NSYNC_WAIT_FOREVER));
+    }
+}
+
+
+
+static void bench_unlock(
+    struct bench_lock *         lock,
+    struct nthread *            thread)
+{
+    if (lock->kind == LOCK_MUTEX) {
+        nmutex_unlock(&lock->mutex, thread);
+    } else {
+        nresource_unlock(&lock->resource, thread);
+    }
+}
+
+
+
+static void thread_finish(
+    struct nthread *            thread)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    nsched_thread_remove_i(thread);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+/* Make the high and medium priority threads ready once the low priority
+ * thread is inside the critical section.
+ */
+static void contenders_start(void)
+{
+    ncore_lock                  sys_lock;
+    uint32_t                    count;
+
+    ncore_lock_enter(&sys_lock);
+    nsched_thread_insert_i(&g_bench.high);
+
+    for (count = 0u; count < g_bench.mediums; count++) {
+        nsched_thread_insert_i(&g_bench.medium[count]);
+    }
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+static void low_run(
+    void *                      arg)
+{
+    (void)arg;
+
+    g_bench.dispatches++;
+
+    if (!g_bench.low_holds && (g_bench.lock.kind == LOCK_CHAIN)) {
+        ncore_lock              sys_lock;
+
+        (void)nresource_lock(&g_bench.lock.inner, &g_bench.low, NSYNC_NO_WAIT);
+        g_bench.low_holds = true;
+        g_bench.low_work  = CRITICAL_SECTION;
+        ncore_lock_enter(&sys_lock);
+        nsched_thread_insert_i(&g_bench.link);                                  /* Link starts the contenders         */
+        ncore_lock_exit(&sys_lock);
+
+        return;
+    }
+
+    if (!g_bench.low_holds) {
+
+        if (bench_lock(&g_bench.lock, &g_bench.low) == NSYNC_ACQUIRED) {
+
+            if (g_bench.lock.kind == LOCK_NESTED) {
+                (void)nresource_lock(&g_bench.lock.inner, &g_bench.low,
+                    NSYNC_NO_WAIT);
+            }
+            g_bench.low_holds = true;
+            g_bench.low_work  = CRITICAL_SECTION;
+            contenders_start();
+        }
+
+        return;
+    }
+
+    if ((g_bench.lock.kind == LOCK_NESTED) &&
+        (g_bench.low_work == (CRITICAL_SECTION / 2u))) {
+        nresource_unlock(&g_bench.lock.inner, &g_bench.low);                    /* Must keep the inherited priority   */
+    }
+
+    if (--g_bench.low_work == 0u) {
+        g_bench.low_holds = false;
+
+        if (g_bench.lock.kind == LOCK_CHAIN) {
+            nresource_unlock(&g_bench.lock.inner, &g_bench.low);
+        } else {
+            bench_unlock(&g_bench.lock, &g_bench.low);
+        }
+        thread_finish(&g_bench.low);
+    }
+}
+
+
+
+static void link_run(
+    void *                      arg)
+{
+    (void)arg;
+
+    g_bench.dispatches++;
+
+    if (!g_bench.link_waits) {
+        (void)nresource_lock(&g_bench.lock.resource, &g_bench.link,
+            NSYNC_NO_WAIT);
+        g_bench.link_waits = true;
+
+        if (nresource_lock(&g_bench.lock.inner, &g_bench.link,
+                NSYNC_WAIT_FOREVER) == NSYNC_PENDING) {
+            contenders_start();
+        }
+
+        return;
+    }
+
+    if (nresource_lock(&g_bench.lock.inner, &g_bench.link,
+            NSYNC_WAIT_FOREVER) == NSYNC_ACQUIRED) {
+        nresource_unlock(&g_bench.lock.inner, &g_bench.link);
+        nresource_unlock(&g_bench.lock.resource, &g_bench.link);
+        thread_finish(&g_bench.link);
+    }
+}
+
+
+
+static void medium_run(
+    void *                      arg)
+{
+    uint32_t *                  work = arg;
+
+    g_bench.dispatches++;
+
+    if (--*work == 0u) {
+        thread_finish(nsched_get_current());
+    }
+}
+
+
+
+static void high_run(
+    void *                      arg)
+{
+    (void)arg;
+
+    g_bench.dispatches++;
+
+    switch (bench_lock(&g_bench.lock, &g_bench.high)) {
+        case NSYNC_PENDING:
+            g_bench.blocked_at = g_bench.dispatches;
+            break;
+        case NSYNC_ACQUIRED:
+            g_bench.blocked = g_bench.dispatches - g_bench.blocked_at;
+            bench_unlock(&g_bench.lock, &g_bench.high);
+            thread_finish(&g_bench.high);
+            nsched_stop();
+            break;
+        default:
+            break;
+    }
+}
+
+
+
+static uint32_t bench_round(
+    int                         kind,
+    uint32_t                    mediums)
+{
+    struct nthread_define       define;
+    uint32_t                    count;
+    ncore_lock                  sys_lock;
+
+    nsched_init();
+    bench_lock_init(&g_bench.lock, kind);
+    g_bench.mediums    = mediums;
+    g_bench.low_holds  = false;
+    g_bench.link_waits = false;
+    g_bench.dispatches = 0u;
+    g_bench.blocked_at = 0u;
+    g_bench.blocked    = 0u;
+
+    define = (struct nthread_define){ .name = "low", .priority = PRIORITY_LOW,
+        .entry = low_run };
+    nsched_thread_init(&g_bench.low, &define);
+    define = (struct nthread_define){ .name = "link",
+        .priority = PRIORITY_LINK, .entry = link_run };
+    nsched_thread_init(&g_bench.link, &define);
+    define = (struct nthread_define){ .name = "high",
+        .priority = PRIORITY_HIGH, .entry = high_run };
+    nsched_thread_init(&g_bench.high, &define);
+
+    for (count = 0u; count < mediums; count++) {
+        g_bench.medium_work[count] = MEDIUM_WORK;
+        define = (struct nthread_define){ .name = "medium",
+            .priority = PRIORITY_MEDIUM, .entry = medium_run,
+            .arg = &g_bench.medium_work[count] };
+        nsched_thread_init(&g_bench.medium[count], &define);
+    }
+    ncore_lock_enter(&sys_lock);
+    nsched_thread_insert_i(&g_bench.low);
+    ncore_lock_exit(&sys_lock);
+    nsched_run();
+
+    return (g_bench.blocked);
+}
+
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+int main(void)
+{
+    uint32_t                    mediums;
+    int                         kind;
+
+    printf("High priority blocking in dispatches, critical section %u\n\n",
+        (unsigned)CRITICAL_SECTION);
+    printf("%8s", "mediums");
+
+    for (kind = LOCK_MUTEX; kind <= LOCK_CHAIN; kind++) {
+        printf("%10s", g_lock_name[kind]);
+    }
+    printf("\n");
+
+    for (mediums = 0u; mediums <= MEDIUM_MAX; mediums++) {
+        printf("%8u", (unsigned)mediums);
+
+        for (kind = LOCK_MUTEX; kind <= LOCK_CHAIN; kind++) {
+            printf("%10u", (unsigned)bench_round(kind, mediums));
+        }
+        printf("\n");
+    }
+
+    return (0);
+}
+
+#if (CONFIG_SCHED_SYNC != 1)
+# error "Neon::Kernel::Bench: Option CONFIG_SCHED_SYNC must be enabled."
+#endif
+/** @} *//*********************************************************************
+ * END of resource_bench.c
+ ******************************************************************************/
@@ -0,0 +1,320 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Timer scaling benchmark
+ * @details     Starts a number of one shot timers, runs the timer tick for a
+ *              fixed window and cancels what is left, for 10^2 up to 10^6
+ *              timers. Three timeout workloads are simulated:
+ *              - uniform: timeouts spread evenly over 1 - 1000 ticks,
+ *              - bimodal: 90% short timeouts of 1 - 16 ticks and 10% long
+ *                timeouts of 5000 - 10000 ticks,
+ *              - tcp: retransmission timeouts of 200 - 300 ticks where 95% of
+ *                timers are cancelled (acknowledged) before they expire.
+ *
+ *              For each run the benchmark reports throughput of
+ *              ntimer_start(), ntimer_cancel(), ntimer_remaining() and of
+ *              expiries in the timer tick, and the worst case time of a
+ *              single tick.
+ *
+ *              Starting a timer in the delta list is linear in the number of
+ *              active timers, so large counts take a long time. The default
+ *              maximum is 10^4 timers, pass a larger one on the command line.
+ *
+ *              Host program, build it together with the kernel sources and
+ *              the host port.
+ *
+ *              Usage: timer_bench [max_timers]
+ *********************************************************************//** @{ */
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "port/core.h"
+#include "misc/timer.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define TIMERS_MIN                      100u
+#define TIMERS_MAX                      1000000u
+#define TIMERS_DEFAULT                  10000u
+
+#define WINDOW                          500u    /* Ticks run for each count   */
+#define TCP_ACKED                       95u     /* Percent of cancelled timers*/
+#define TCP_RTO_MIN                     200u
+
+#define WORKLOAD_UNIFORM                0
+#define WORKLOAD_BIMODAL                1
+#define WORKLOAD_TCP                    2
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+struct bench_result
+{
+    uint64_t                    start_ns;
+    uint64_t                    cancel_ns;
+    uint64_t                    remaining_ns;
+    uint64_t                    isr_ns;
+    uint64_t                    isr_max_ns;
+    uint32_t                    cancelled;
+    uint32_t                    expired;
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const char * const       g_workload_name[] =
+{
+    "uniform",
+    "bimodal",
+    "tcp"
+};
+
+static uint32_t                 g_random = 2463534242u;
+static uint32_t                 g_expired;
+
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static uint64_t bench_now(void)
+{
+    struct timespec             now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+}
+
+
+
+static uint32_t bench_random(
+    uint32_t                    min,
+    uint32_t                    max)
+{
+    g_random ^= g_random << 13;
+    g_random ^= g_random >> 17;
+    g_random ^= g_random << 5;
+
+    return (min + g_random % (max - min + 1u));
+}
+
+
+
+static ncore_time_tick bench_timeout(
+    int                         workload)
+{
+    switch (workload) {
+        case WORKLOAD_UNIFORM:
+            return (bench_random(1u, 1000u));
+        case WORKLOAD_BIMODAL:
+            if (bench_random(1u, 100u) <= 90u) {
+                return (bench_random(1u, 16u));
+            } else {
+                return (bench_random(5000u, 10000u));
+            }
+        default:
+            return (bench_random(TCP_RTO_MIN, 300u));
+    }
+}
+
+
+
+static void expire(
+    void *                      arg)
+{
+    (void)arg;
+
+    g_expired++;
+}
+
+
+
+/* Cancel timers in range [begin, end) which are acknowledged, that is all
+ * except every (100 / (100 - TCP_ACKED))-th one.
+ */
+static void tcp_acknowledge(
+    struct ntimer *             timers,
+    uint32_t                    begin,
+    uint32_t                    end,
+    struct bench_result *       result)
+{
+    uint32_t                    count;
+    uint64_t                    stamp;
+
+    stamp = bench_now();
+
+    for (count = begin; count < end; count++) {
+
+        if ((count % (100u / (100u - TCP_ACKED))) != 0u) {
+            ntimer_cancel(&timers[count]);
+            result->cancelled++;
+        }
+    }
+    result->cancel_ns += bench_now() - stamp;
+}
+
+
+
+static void bench_round(
+    int                         workload,
+    struct ntimer *             timers,
+    uint32_t                    count,
+    struct bench_result *       result)
+{
+    volatile ncore_time_tick    remaining;
+    uint32_t                    tick;
+    uint32_t                    idx;
+    uint64_t                    stamp;
+
+    *result   = (struct bench_result){ 0 };
+    g_expired = 0u;
+
+    for (idx = 0u; idx < count; idx++) {
+        ntimer_init(&timers[idx]);
+    }
+    stamp = bench_now();
+
+    for (idx = 0u; idx < count; idx++) {
+        ntimer_start(&timers[idx], bench_timeout(workload), expire, NULL,
+            NTIMER_ATTR_ONE_SHOT);
+    }
+    result->start_ns = bench_now() - stamp;
+    stamp = bench_now();
+
+    for (idx = 0u; idx < count; idx++) {
+        remaining = ntimer_remaining(&timers[idx]);
+    }
+    result->remaining_ns = bench_now() - stamp;
+    (void)remaining;
+
+    for (tick = 0u; tick < WINDOW; tick++) {
+        uint64_t                isr_ns;
+
+        if ((workload == WORKLOAD_TCP) && (tick < TCP_RTO_MIN - 1u)) {          /* Acknowledges arrive before RTO     */
+            tcp_acknowledge(timers, count * tick / (TCP_RTO_MIN - 1u),
+                count * (tick + 1u) / (TCP_RTO_MIN - 1u), result);
+        }
+        stamp  = bench_now();
+        ntimer_domain_isr(ntimer_domain_default());                             /* Same as ncore_timer_isr()          */
+        isr_ns = bench_now() - stamp;
+        result->isr_ns += isr_ns;
+
+        if (result->isr_max_ns < isr_ns) {
+            result->isr_max_ns = isr_ns;
+        }
+    }
+    stamp = bench_now();
+
+    for (idx = 0u; idx < count; idx++) {
+        ncore_lock              sys_lock;
+
+        ncore_lock_enter(&sys_lock);
+
+        if (ntimer_is_running_i(&timers[idx])) {
+            ntimer_cancel_i(&timers[idx]);
+            result->cancelled++;
+        }
+        ncore_lock_exit(&sys_lock);
+    }
+    result->cancel_ns += bench_now() - stamp;
+    result->expired    = g_expired;
+}
+
+
+
+static double bench_mops(
+    uint32_t                    ops,
+    uint64_t                    ns)
+{
+    if (ns == 0u) {
+        return (0.0);
+    }
+
+    return ((double)ops * 1000.0 / (double)ns);
+}
+
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+int main(
+    int                         argc,
+    char **                     argv)
+{
+    struct ntimer *             timers;
+    uint32_t                    max;
+    uint32_t                    count;
+    int                         workload;
+
+    max = TIMERS_DEFAULT;
+
+    if (argc > 1) {
+        max = (uint32_t)strtoul(argv[1], NULL, 10);
+
+        if ((max < TIMERS_MIN) || (max > TIMERS_MAX)) {
+            fprintf(stderr, "max_timers must be in range %u - %u\n",
+                (unsigned)TIMERS_MIN, (unsigned)TIMERS_MAX);
+
+            return (1);
+        }
+    }
+    timers = malloc(sizeof(*timers) * max);
+
+    if (timers == NULL) {
+        fprintf(stderr, "out of memory\n");
+
+        return (1);
+    }
+
+    for (workload = WORKLOAD_UNIFORM; workload <= WORKLOAD_TCP; workload++) {
+        printf("Workload %s, %u ticks\n", g_workload_name[workload],
+            (unsigned)WINDOW);
+        printf("%9s%10s%10s%10s%10s%10s%10s\n", "timers", "start", "cancel",
+            "remain", "expire", "expired", "isr max");
+        printf("%9s%10s%10s%10s%10s%10s%10s\n", "", "[Mop/s]", "[Mop/s]",
+            "[Mop/s]", "[Mop/s]", "", "[us]");
+
+        for (count = TIMERS_MIN; count <= max; count *= 10u) {
+            struct bench_result result;
+
+            bench_round(workload, timers, count, &result);
+            printf("%9u%10.2f%10.2f%10.2f%10.2f%10u%10.2f\n", (unsigned)count,
+                bench_mops(count, result.start_ns),
+                bench_mops(result.cancelled, result.cancel_ns),
+                bench_mops(count, result.remaining_ns),
+                bench_mops(result.expired, result.isr_ns),
+                (unsigned)result.expired,
+                (double)result.isr_max_ns / 1000.0);
+        }
+        printf("\n");
+    }
+    free(timers);
+
+    return (0);
+}
+
+/** @} *//*********************************************************************
+ * END of timer_bench.c
+ ******************************************************************************/
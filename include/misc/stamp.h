@@ -0,0 +1,143 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Time stamp counter
+ * @defgroup    base_stamp Time stamp counter
+ * @brief       Time stamp counter
+ *********************************************************************//** @{ */
+/**@defgroup    base_stamp_intf Interface
+ * @brief       Time stamp counter API
+ * @{ *//*--------------------------------------------------------------------*/
+
+#ifndef NSTAMP_H
+#define NSTAMP_H
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+
+#include "port/compiler.h"
+#include "port/core.h"
+#include "shared/config.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Read the free running time stamp counter
+ * @details     The application or port maps this macro to a free running
+ *              counter of the CPU, like DWT CYCCNT on Cortex-M or TSC on x86.
+ *              When it is not defined all measurements read zero.
+ * @api
+ */
+#if !defined(CONFIG_STAMP_GET)
+#define CONFIG_STAMP_GET()              (0u)
+#endif
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Time stamp type
+ * @api
+ */
+typedef uint32_t nstamp;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Get current time stamp
+ * @api
+ */
+PORT_C_INLINE
+nstamp nstamp_get(void)
+{
+    return ((nstamp)CONFIG_STAMP_GET());
+}
+
+
+
+/**@brief       Get difference between two time stamps
+ * @details     The difference is correct across one counter overflow.
+ * @api
+ */
+PORT_C_INLINE
+nstamp nstamp_delta(
+    nstamp                      begin,
+    nstamp                      end)
+{
+    return ((nstamp)(end - begin));
+}
+
+
+
+/**@brief       Get logarithmic histogram bucket of a value
+ * @param       value
+ *              Value to classify
+ * @param       buckets
+ *              Number of buckets in histogram
+ * @return      Bucket 0 holds value 0, bucket @c n holds values in range
+ *              [2^(n-1), 2^n). The last bucket holds all larger values.
+ * @api
+ */
+PORT_C_INLINE
+uint_fast8_t nstamp_log2_bucket(
+    uint32_t                    value,
+    uint_fast8_t                buckets)
+{
+    uint_fast8_t                bucket;
+
+#if (NCPU_DATA_WIDTH >= 32)
+    if (value == 0u) {
+        bucket = 0u;
+    } else {
+        bucket = (uint_fast8_t)(ncore_log2((ncpu_reg)value) + 1u);
+    }
+#else
+    bucket = 0u;
+
+    while (value != 0u) {
+        value >>= 1;
+        bucket++;
+    }
+#endif
+
+    if (bucket >= buckets) {
+        bucket = (uint_fast8_t)(buckets - 1u);
+    }
+
+    return (bucket);
+}
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of stamp.h
+ ******************************************************************************/
+#endif /* NSTAMP_H */
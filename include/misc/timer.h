@@ -41,6 +41,7 @@
 #include "port/core.h"
 #include "shared/config.h"
 #include "shared/list.h"
+#include "misc/stamp.h"
 
 /*===============================================================  MACRO's  ==*/
 
@@ -52,6 +53,66 @@
 #define NTIMER_ATTR_ONE_SHOT            (0x1u << 0)
 #define NTIMER_ATTR_REPEAT              (0x1u << 1)
 
+/**@brief       Call the timer callback from the deferred work thread
+ * @details     Without this attribute the callback is called from
+ *              @ref ncore_timer_isr(). Has effect only when
+ *              @ref CONFIG_TIMER_DEFERRED is enabled.
+ */
+#define NTIMER_ATTR_DEFERRED            (0x1u << 2)
+
+/**@brief       Enable deferred timer callbacks
+ * @details     When enabled, callbacks of timers started with
+ *              @ref NTIMER_ATTR_DEFERRED are not called in interrupt context.
+ *              Expired timers are put on a deferred work list which is
+ *              processed by a kernel thread, see @ref ntimer_deferred_init().
+ *              Deferred callbacks are called without the core lock held.
+ */
+#if !defined(CONFIG_TIMER_DEFERRED)
+#define CONFIG_TIMER_DEFERRED           0
+#endif
+
+/**@brief       Priority of the deferred work thread
+ */
+#if !defined(CONFIG_TIMER_DEFERRED_PRIORITY)
+#define CONFIG_TIMER_DEFERRED_PRIORITY  (CONFIG_PRIORITY_LEVELS - 1u)
+#endif
+
+/**@brief       Maximum number of deferred callbacks called in one dispatch
+ * @details     The thread stays ready while there is more work, so other
+ *              threads of the same priority get a turn between batches.
+ */
+#if !defined(CONFIG_TIMER_DEFERRED_BATCH)
+#define CONFIG_TIMER_DEFERRED_BATCH     8u
+#endif
+
+/**@brief       Enable timer slack
+ * @details     When enabled, a timer may be given a slack window with
+ *              @ref ntimer_set_slack(). Its expiry is then moved, within the
+ *              window, to the expiry of an already running timer, so both
+ *              fire on the same tick. Fewer distinct expiries mean fewer
+ *              wakeups and longer idle periods.
+ */
+#if !defined(CONFIG_TIMER_SLACK)
+#define CONFIG_TIMER_SLACK              0
+#endif
+
+/**@brief       Enable timer statistics
+ * @details     When enabled, each timer domain records histograms of expiry
+ *              lateness, callback duration and number of timers expired per
+ *              tick, and the longest timer queue. The data is read with
+ *              @ref ntimer_domain_stats(). When disabled, no code or data is
+ *              added.
+ */
+#if !defined(CONFIG_TIMER_STATS)
+#define CONFIG_TIMER_STATS              0
+#endif
+
+/**@brief       Number of log2 buckets in timer histograms
+ */
+#if !defined(CONFIG_TIMER_STATS_BUCKETS)
+#define CONFIG_TIMER_STATS_BUCKETS      16u
+#endif
+
 /*------------------------------------------------------  C++ extern begin  --*/
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +120,8 @@ extern "C" {
 
 /*============================================================  DATA TYPES  ==*/
 
+struct ntimer_domain;
+
 /**@brief       Virtual Timer structure
  */
 struct ntimer
@@ -68,24 +131,153 @@ struct ntimer
     ncore_time_tick             itick;            	/**<@brief Initial ticks  */
     void                     (* fn)(void *);        /**<@brief Callback       */
     void *                      arg;                /**<@brief Argument       */
+    struct ntimer_domain *      domain;             /**<@brief Owner domain   */
+    ncore_time_tick             expiry;             /**<@brief Absolute tick of
+                                                     *   queue position       */
+    ncore_time_tick             deadline;           /**<@brief Absolute tick of
+                                                     *   callback call        */
 #if (CONFIG_API_VALIDATION == 1)
     unsigned int                signature;          /**<@brief Debug signature*/
 #endif
+#if (CONFIG_TIMER_DEFERRED == 1)
+    struct ndlist               deferred;           /**<@brief Deferred work
+                                                     *   list node            */
+    uint8_t                     flags;              /**<@brief Attributes     */
+    bool                        is_in_flight;       /**<@brief Deferred
+                                                     *   callback is running  */
+#endif
+#if (CONFIG_TIMER_SLACK == 1)
+    ncore_time_tick             slack;              /**<@brief Allowed delay  */
+#endif
+#if (CONFIG_TIMER_STATS == 1)
+    ncore_time_tick             target;             /**<@brief Requested
+                                                     *   absolute expiry      */
+    ncore_time_tick             fired;              /**<@brief Requested
+                                                     *   expiry of the last
+                                                     *   firing               */
+#endif
 };
 
 /**@brief       Virtual Timer structure type
  */
 typedef struct ntimer ntimer;
 
+#if (CONFIG_TIMER_STATS == 1) || defined(__DOXYGEN__)
+/**@brief       Timer domain statistics
+ * @details     Histograms use log2 buckets: bucket 0 counts zero values,
+ *              bucket n counts values in range [2^(n-1), 2^n). The last
+ *              bucket also counts all larger values.
+ */
+struct ntimer_stats
+{
+    uint32_t                    ticks;          /**<@brief Ticks processed    */
+    uint32_t                    expired;        /**<@brief Callbacks called   */
+    ncore_time_tick             lateness_max;   /**<@brief Most ticks late    */
+    uint32_t                    lateness_hist[CONFIG_TIMER_STATS_BUCKETS];      /**<@brief Ticks between requested
+                                                                                 *   expiry and callback call */
+    nstamp                      callback_max;   /**<@brief Longest callback   */
+    uint32_t                    callback_hist[CONFIG_TIMER_STATS_BUCKETS];      /**<@brief Callback duration  */
+    uint32_t                    per_tick_max;   /**<@brief Most expiries in a
+                                                 *         tick               */
+    uint32_t                    per_tick_hist[CONFIG_TIMER_STATS_BUCKETS];      /**<@brief Expiries per tick  */
+    uint32_t                    queue_max;      /**<@brief Longest queue      */
+};
+#endif
+
+/**@brief       Timer domain
+ * @details     A set of timers with its own expiry queue, driven by its own
+ *              tick source through @ref ntimer_domain_isr(). A core which owns
+ *              a domain doesn't share timer state with other cores. Timers
+ *              started without a domain belong to the default domain which is
+ *              driven by @ref ncore_timer_isr().
+ */
+struct ntimer_domain
+{
+    struct ntimer               sentinel;           /**<@brief Queue sentinel */
+    ncore_time_tick             now;                /**<@brief Current tick   */
+#if (CONFIG_TIMER_SLACK == 1)
+    uint32_t                    coalesced;          /**<@brief Merged expiries*/
+#endif
+#if (CONFIG_TIMER_STATS == 1)
+    struct ntimer_stats         stats;              /**<@brief Statistics     */
+    uint32_t                    length;             /**<@brief Queue length   */
+#endif
+};
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*===================================================  FUNCTION PROTOTYPES  ==*/
 
 
+/**@brief       Initialize a timer domain
+ * @param       domain
+ *              Pointer to timer domain structure
+ */
+void ntimer_domain_init(
+    struct ntimer_domain *      domain);
+
+
+
+/**@brief       Get the default timer domain
+ */
+struct ntimer_domain * ntimer_domain_default(void);
+
+
+
+/**@brief       Process one tick of a timer domain
+ * @param       domain
+ *              Pointer to timer domain structure
+ * @details     Called from the tick source of the domain, with the same
+ *              context requirements as @ref ncore_timer_isr().
+ * @iclass
+ */
+void ntimer_domain_isr(
+    struct ntimer_domain *      domain);
+
+
+
 void ntimer_init(
     struct ntimer *             timer);
 
 
 
+/**@brief       Start a timer in a timer domain
+ * @param       domain
+ *              Pointer to timer domain structure
+ * @param       timer
+ *              Pointer to timer structure
+ * @param       tick
+ *              Number of ticks to run
+ * @param       fn
+ *              Pointer to callback function
+ * @param       arg
+ *              Argument for callback function
+ * @details     The timer stays in the domain until it is started again, so
+ *              it is cancelled without naming the domain.
+ * @iclass
+ */
+void ntimer_domain_start_i(
+    struct ntimer_domain *      domain,
+    struct ntimer *             timer,
+    ncore_time_tick             tick,
+    void                     (* fn)(void *),
+    void *                      arg,
+    uint8_t                     flags);
+
+
+
+/**@brief       Start a timer in a timer domain
+ * @api
+ */
+void ntimer_domain_start(
+    struct ntimer_domain *      domain,
+    struct ntimer *             timer,
+    ncore_time_tick             tick,
+    void                     (* fn)(void *),
+    void *                      arg,
+    uint8_t                     flags);
+
+
+
 /**@brief       Start a timer
  * @param       timer
  *              Pointer to timer structure
@@ -126,12 +318,51 @@ void ntimer_start(
 
 
 
+/**@brief       Restart a timer with a new timeout
+ * @param       timer
+ *              Pointer to timer structure, it must have been started before
+ * @param       tick
+ *              Number of ticks to run, counted from now
+ * @details     The callback, argument, attributes and domain of the last
+ *              start are kept. A repeating timer also gets @c tick as its new
+ *              period.
+ *
+ *              When a running timer is pushed later, which is the common case
+ *              of an idle timeout reset, only its deadline is updated. The
+ *              timer keeps its queue position and is moved when it reaches it.
+ *              Only a timer which has to expire earlier is moved in the queue
+ *              at once.
+ * @iclass
+ */
+void ntimer_restart_i(
+    struct ntimer *             timer,
+    ncore_time_tick             tick);
+
+
+
+/**@brief       Restart a timer with a new timeout
+ * @api
+ */
+void ntimer_restart(
+    struct ntimer *             timer,
+    ncore_time_tick             tick);
+
+
+
 /**@brief       Terminate a timer
  * @param       timer
  *              Pointer to timer structure
+ * @return      Deferred callback state
+ *  @retval     TRUE - a deferred callback of the timer is running right now
+ *  @retval     FALSE - no callback of the timer will be called anymore
+ * @details     Cancel does not wait for a deferred callback which is already
+ *              running without the lock. When TRUE is returned that callback
+ *              completes after the return, so the timer and the callback
+ *              argument must stay valid until it does. Always FALSE without
+ *              @ref CONFIG_TIMER_DEFERRED.
  * @iclass
  */
-void ntimer_cancel_i(
+bool ntimer_cancel_i(
     struct ntimer *             timer);
 
 
@@ -139,9 +370,10 @@ void ntimer_cancel_i(
 /**@brief       Terminate a timer
  * @param       timer
  *              Pointer to timer structure
+ * @return      Deferred callback state, see @ref ntimer_cancel_i()
  * @api
  */
-void ntimer_cancel(
+bool ntimer_cancel(
     struct ntimer *             timer);
 
 
@@ -162,12 +394,125 @@ bool ntimer_is_running_i(
 ncore_time_tick ntimer_remaining(
     const struct ntimer *       timer);
 
+
+
+/**@brief       Get the number of ticks until the next timer of the default
+ *              domain expires
+ * @return      Number of ticks, or @ref NCORE_TIME_TICK_MAX when no timer is
+ *              running.
+ * @details     Used by idle hooks to decide how long the CPU may sleep.
+ * @iclass
+ */
+ncore_time_tick ntimer_next_expiry_i(void);
+
+
+
+/**@brief       Get the number of ticks until the next timer of a domain
+ *              expires
+ * @iclass
+ */
+ncore_time_tick ntimer_domain_next_expiry_i(
+    const struct ntimer_domain * domain);
+
+
+
+#if (CONFIG_TIMER_SLACK == 1) || defined(__DOXYGEN__)
+/**@brief       Set slack of a timer
+ * @param       timer
+ *              Pointer to timer structure
+ * @param       slack
+ *              Number of ticks the timer may expire late. Value 0, the
+ *              default, keeps the exact expiry.
+ * @details     Takes effect the next time the timer is started or repeated.
+ * @api
+ */
+void ntimer_set_slack(
+    struct ntimer *             timer,
+    ncore_time_tick             slack);
+
+
+
+/**@brief       Get the number of wakeups saved by coalescing
+ * @return      Number of times a timer expiry was moved onto the expiry of
+ *              another timer.
+ * @api
+ */
+uint32_t ntimer_coalesced(void);
+
+
+
+/**@brief       Get the number of wakeups saved by coalescing in a domain
+ * @api
+ */
+uint32_t ntimer_domain_coalesced(
+    const struct ntimer_domain * domain);
+#endif
+
+
+
+#if (CONFIG_TIMER_STATS == 1) || defined(__DOXYGEN__)
+/**@brief       Take a snapshot of timer domain statistics
+ * @param       domain
+ *              Pointer to timer domain structure
+ * @param       stats
+ *              Pointer to structure which will receive the statistics
+ * @details     Callback duration is measured with @ref nstamp_get().
+ * @api
+ */
+void ntimer_domain_stats(
+    const struct ntimer_domain * domain,
+    struct ntimer_stats *       stats);
+
+
+
+/**@brief       Clear timer domain statistics
+ * @api
+ */
+void ntimer_domain_stats_clear(
+    struct ntimer_domain *      domain);
+#endif
+
+
+
+#if (CONFIG_TIMER_DEFERRED == 1) || defined(__DOXYGEN__)
+/**@brief       Initialize the deferred work thread
+ * @details     Must be called after the scheduler is initialized and before
+ *              any timer with @ref NTIMER_ATTR_DEFERRED expires.
+ */
+void ntimer_deferred_init(void);
+#endif
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
 #endif
 
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if ((CONFIG_TIMER_DEFERRED != 0) && (CONFIG_TIMER_DEFERRED != 1))
+# error "Neon::Kernel::Virtual timer: Configuration option CONFIG_TIMER_DEFERRED is out of range."
+#endif
+
+#if ((CONFIG_TIMER_SLACK != 0) && (CONFIG_TIMER_SLACK != 1))
+# error "Neon::Kernel::Virtual timer: Configuration option CONFIG_TIMER_SLACK is out of range."
+#endif
+
+#if ((CONFIG_TIMER_STATS != 0) && (CONFIG_TIMER_STATS != 1))
+# error "Neon::Kernel::Virtual timer: Configuration option CONFIG_TIMER_STATS is out of range."
+#endif
+
+#if (CONFIG_TIMER_STATS_BUCKETS < 1u) || (CONFIG_TIMER_STATS_BUCKETS > 33u)
+# error "Neon::Kernel::Virtual timer: Configuration option CONFIG_TIMER_STATS_BUCKETS is out of range."
+#endif
+
+#if (CONFIG_TIMER_DEFERRED_PRIORITY >= CONFIG_PRIORITY_LEVELS)
+# error "Neon::Kernel::Virtual timer: Configuration option CONFIG_TIMER_DEFERRED_PRIORITY is out of range."
+#endif
+
+#if (CONFIG_TIMER_DEFERRED_BATCH < 1u)
+# error "Neon::Kernel::Virtual timer: Configuration option CONFIG_TIMER_DEFERRED_BATCH is out of range."
+#endif
+
 /** @endcond *//** @} *//** @} *//*********************************************
  * END of ntimer.h
  ******************************************************************************/
@@ -0,0 +1,236 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Binary event trace
+ * @defgroup    base_trace Binary event trace
+ * @brief       Binary event trace
+ *********************************************************************//** @{ */
+/**@defgroup    base_trace_intf Interface
+ * @brief       Binary event trace API
+ * @{ *//*--------------------------------------------------------------------*/
+
+#ifndef NTRACE_H
+#define NTRACE_H
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "port/compiler.h"
+#include "shared/config.h"
+#include "misc/stamp.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Enable binary event trace
+ * @details     When enabled, the scheduler, virtual timers and memory
+ *              allocators record compact events into a ring buffer. When
+ *              disabled, the trace points expand to nothing.
+ * @api
+ */
+#if !defined(CONFIG_TRACE)
+#define CONFIG_TRACE                    0
+#endif
+
+/**@brief       Number of events in trace ring buffer
+ * @details     Must be a power of two.
+ * @api
+ */
+#if !defined(CONFIG_TRACE_EVENTS)
+#define CONFIG_TRACE_EVENTS             1024u
+#endif
+
+/**@brief       Frequency of time stamp counter in Hz
+ * @details     It is written into the dump header so tools can convert time
+ *              stamps into time.
+ * @api
+ */
+#if !defined(CONFIG_TRACE_STAMP_FREQ)
+#define CONFIG_TRACE_STAMP_FREQ         1000000ul
+#endif
+
+/**@brief       Trace dump header magic number and version
+ * @{ */
+#define NTRACE_MAGIC                    0x4e545243u
+#define NTRACE_VERSION                  1u
+/** @} */
+
+/**@brief       Trace event types
+ * @details     Type zero marks an event which was lost while dumping.
+ *              Meaning of event object and argument:
+ *              - thread events: thread, priority
+ *              - idle: NULL, 0
+ *              - timer fire: timer, 0
+ *              - memory events: allocator instance, size
+ * @{ */
+#define NTRACE_THREAD_INSERT            1u
+#define NTRACE_THREAD_REMOVE            2u
+#define NTRACE_THREAD_DISPATCH          3u
+#define NTRACE_SCHED_IDLE               4u
+#define NTRACE_TIMER_FIRE               5u
+#define NTRACE_MEM_ALLOC                6u
+#define NTRACE_MEM_FREE                 7u
+/** @} */
+
+/**@brief       Trace point
+ * @details     Must be called with the core lock held.
+ * @api
+ */
+#if (CONFIG_TRACE == 1)
+#define NTRACE(type, object, arg)                                               \
+    ntrace_record_i((type), (object), (uint32_t)(arg))
+#else
+#define NTRACE(type, object, arg)       (void)0
+#endif
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Trace event
+ * @details     Object is stored as lower 32 bits of its address, which is
+ *              enough to tell objects apart.
+ * @api
+ */
+struct ntrace_event
+{
+    nstamp                      stamp;          /**<@brief Time stamp         */
+    uint32_t                    object;         /**<@brief Object identifier  */
+    uint32_t                    arg;            /**<@brief Event argument     */
+    uint16_t                    type;           /**<@brief Event type         */
+    uint16_t                    reserved;
+};
+
+/**@brief       Trace dump header
+ * @details     The header is followed by @c count events, oldest first.
+ * @api
+ */
+struct ntrace_header
+{
+    uint32_t                    magic;          /**<@brief NTRACE_MAGIC       */
+    uint16_t                    version;        /**<@brief NTRACE_VERSION     */
+    uint16_t                    event_size;     /**<@brief Size of one event  */
+    uint32_t                    count;          /**<@brief Number of events   */
+    uint32_t                    stamp_freq;     /**<@brief Stamp counter, Hz  */
+};
+
+#if (CONFIG_TRACE == 1) || defined(__DOXYGEN__)
+/**@brief       Trace ring buffer
+ * @notapi
+ */
+struct ntrace_ring
+{
+    volatile uint32_t           head;           /**<@brief Events written     */
+    struct ntrace_event         event[CONFIG_TRACE_EVENTS];
+};
+#endif
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+
+#if (CONFIG_TRACE == 1) || defined(__DOXYGEN__)
+/**@brief       Trace ring buffer instance
+ * @notapi
+ */
+extern struct ntrace_ring       g_trace_ring;
+#endif
+
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_TRACE == 1) || defined(__DOXYGEN__)
+
+
+/**@brief       Record an event
+ * @details     The ring buffer has a single writer which always runs with the
+ *              core lock held, so recording does not take any additional lock.
+ *              Use @ref NTRACE macro instead of calling this function directly.
+ * @iclass
+ */
+PORT_C_INLINE
+void ntrace_record_i(
+    uint_fast16_t               type,
+    const void *                object,
+    uint32_t                    arg)
+{
+    struct ntrace_event *       event;
+    uint32_t                    head;
+
+    head            = g_trace_ring.head;
+    event           = &g_trace_ring.event[head & (CONFIG_TRACE_EVENTS - 1u)];
+    event->stamp    = nstamp_get();
+    event->object   = (uint32_t)(uintptr_t)object;
+    event->arg      = arg;
+    event->type     = (uint16_t)type;
+    event->reserved = 0u;
+    g_trace_ring.head = head + 1u;              /* Publish the event.         */
+}
+
+
+
+/**@brief       Write trace header and events to output
+ * @param       write
+ *              Output function. It receives @c arg, pointer to data and size
+ *              of data in bytes.
+ * @param       arg
+ *              Argument for output function
+ * @return      Number of events written.
+ * @details     The ring buffer is read without taking the core lock, so the
+ *              trace may stay enabled while dumping. Events which are
+ *              overwritten while being read are left out.
+ * @api
+ */
+size_t ntrace_dump(
+    void                     (* write)(void *, const void *, size_t),
+    void *                      arg);
+
+
+
+/**@brief       Discard all recorded events
+ * @api
+ */
+void ntrace_clear(void);
+
+#endif /* (CONFIG_TRACE == 1) */
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if ((CONFIG_TRACE != 0) && (CONFIG_TRACE != 1))
+# error "Neon::Kernel::Trace: Configuration option CONFIG_TRACE is out of range."
+#endif
+
+#if ((CONFIG_TRACE_EVENTS & (CONFIG_TRACE_EVENTS - 1u)) != 0u)
+# error "Neon::Kernel::Trace: CONFIG_TRACE_EVENTS must be a power of two."
+#endif
+
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of trace.h
+ ******************************************************************************/
+#endif /* NTRACE_H */
@@ -31,11 +31,87 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "mm/mem.h"
 
 /*===============================================================  MACRO's  ==*/
+
+/**@brief       Enable small-object front-end
+ * @details     When enabled, requests up to @ref NHEAP_FE_MAX_SIZE bytes are
+ *              served from per-size-class free lists. The lists are refilled
+ *              in bulk from the underlying heap, so small allocation and
+ *              deallocation become a single pointer pop/push.
+ * @api
+ */
+#if !defined(CONFIG_HEAP_FRONTEND)
+#define CONFIG_HEAP_FRONTEND            0
+#endif
+
+/**@brief       Size class granularity of the small-object front-end in bytes
+ * @api
+ */
+#if !defined(CONFIG_HEAP_FE_GRANULE)
+#define CONFIG_HEAP_FE_GRANULE          16u
+#endif
+
+/**@brief       Number of size classes of the small-object front-end
+ * @api
+ */
+#if !defined(CONFIG_HEAP_FE_CLASSES)
+#define CONFIG_HEAP_FE_CLASSES          16u
+#endif
+
+/**@brief       Number of objects taken from the heap on each class refill
+ * @api
+ */
+#if !defined(CONFIG_HEAP_FE_REFILL)
+#define CONFIG_HEAP_FE_REFILL           8u
+#endif
+
+/**@brief       Enable incremental heap integrity checker
+ * @details     When enabled, the heap keeps a cursor for @ref nheap_check()
+ *              and every block given to free functions is validated before
+ *              it is merged with its neighbours. A double free, also of a
+ *              small object of the front-end, is counted as corruption, see
+ *              @ref nheap_corrupted().
+ * @api
+ */
+#if !defined(CONFIG_HEAP_CHECK)
+#define CONFIG_HEAP_CHECK               0
+#endif
+
+/**@brief       Enable guard canary right after each allocated object
+ * @details     The canary is placed right after the requested size, so also
+ *              overflows into the alignment padding are detected. Blocks with
+ *              a damaged canary are not freed, see @ref nheap_corrupted().
+ * @api
+ */
+#if !defined(CONFIG_HEAP_CANARY)
+#define CONFIG_HEAP_CANARY              0
+#endif
+
+/**@brief       Store heap block links as offsets instead of pointers
+ * @details     When enabled, block links are relative to the heap storage and
+ *              the storage starts with a small image header. Such a heap can
+ *              be saved and later attached at a different address, see
+ *              @ref nheap_attach(). It can't be used together with
+ *              @ref CONFIG_HEAP_FRONTEND, since objects cached by the
+ *              front-end are not part of the image.
+ * @api
+ */
+#if !defined(CONFIG_HEAP_OFFSET_LINKS)
+#define CONFIG_HEAP_OFFSET_LINKS        0
+#endif
+
+/**@brief       Largest request served by the small-object front-end
+ * @api
+ */
+#define NHEAP_FE_MAX_SIZE                                                       \
+    (CONFIG_HEAP_FE_GRANULE * CONFIG_HEAP_FE_CLASSES)
+
 /*------------------------------------------------------  C++ extern begin  --*/
 #ifdef __cplusplus
 extern "C" {
@@ -45,12 +121,24 @@ extern "C" {
 
 /**@brief       Heap memory instance structure
  * @details     This structure holds information about dynamic memory instance.
+ * @note        When @ref CONFIG_HEAP_FRONTEND is enabled, memory taken by the
+ *              small-object front-end stays in its size class free lists and
+ *              is not returned to the coalescing heap.
  * @see         nheap_init()
  * @api
  */
 struct nheap
 {
     struct nmem                 mem_class;
+#if (CONFIG_HEAP_FRONTEND == 1) || defined(__DOXYGEN__)
+    void *                      fe_free[CONFIG_HEAP_FE_CLASSES];                /**<@brief Size class free lists      */
+#endif
+#if (CONFIG_HEAP_CHECK == 1) || defined(__DOXYGEN__)
+    void *                      check_cursor;                                   /**<@brief Next block to check        */
+#endif
+#if (CONFIG_HEAP_CHECK == 1) || (CONFIG_HEAP_CANARY == 1) || defined(__DOXYGEN__)
+    uint32_t                    corrupted;                                      /**<@brief Corrupted blocks not freed */
+#endif
 };
 
 /**@brief       Heap memory instance type
@@ -80,6 +168,58 @@ void nheap_init(
 
 
 
+#if (CONFIG_HEAP_OFFSET_LINKS == 1) || defined(__DOXYGEN__)
+/**@brief       Attach heap structure instance to an existing heap image
+ * @param       heap
+ *              Pointer to heap structure instance, see @ref nheap.
+ * @param       storage
+ *              Pointer to memory holding heap image previously created by
+ *              @ref nheap_init(). It may be mapped at a different address.
+ * @param       size
+ *              Size of storage in bytes, must be the same as when the image was
+ *              created.
+ * @return      Attach state:
+ *  @retval     true - the image is consistent and the heap is ready for use
+ *  @retval     false - the image is not recognized or it is corrupted, the
+ *              storage must be initialized with @ref nheap_init().
+ * @details     All blocks and the free list are validated before the heap is
+ *              accepted.
+ * @api
+ */
+bool nheap_attach(
+    struct nheap *              heap,
+    void *                      storage,
+    size_t                      size);
+
+
+
+/**@brief       Set application root object of heap image
+ * @param       heap
+ *              Pointer to heap structure instance
+ * @param       root
+ *              Pointer to memory allocated from this heap or NULL
+ * @details     The root is saved in the heap image and it is the entry point
+ *              to application data after the heap is attached again.
+ * @api
+ */
+void nheap_set_root(
+    struct nheap *              heap,
+    void *                      root);
+
+
+
+/**@brief       Get application root object of heap image
+ * @param       heap
+ *              Pointer to heap structure instance
+ * @return      Pointer to root object or NULL if it was never set.
+ * @api
+ */
+void * nheap_get_root(
+    const struct nheap *        heap);
+#endif
+
+
+
 /**@brief       Terminate heap instance
  * @param       heap
  *              Pointer to heap structure instance
@@ -112,12 +252,121 @@ void nheap_free(
     struct nheap *              heap,
     void *                      mem);
 
+
+
+#if (CONFIG_HEAP_CHECK == 1) || (CONFIG_HEAP_CANARY == 1) || defined(__DOXYGEN__)
+/**@brief       Get number of corrupted blocks given to free functions
+ * @param       heap
+ *              Pointer to heap structure instance
+ * @return      Number of blocks which were found corrupted when freed. Such
+ *              blocks are leaked instead of merged with their neighbours.
+ * @details     The counter is kept in all builds, also when API validation is
+ *              disabled and the corruption is not asserted.
+ * @api
+ */
+uint32_t nheap_corrupted(
+    const struct nheap *        heap);
+#endif
+
+
+
+/**@brief       Walk and validate all heap blocks
+ * @param       heap
+ *              Pointer to heap structure instance
+ * @param       fn
+ *              Function which is called for each block, in address order. It
+ *              gets the block memory, block size in bytes and block state.
+ *              Can be NULL when only validation is needed.
+ * @param       arg
+ *              Argument passed to @c fn.
+ * @return      Heap state:
+ *  @retval     true - all blocks and the free list are consistent
+ *  @retval     false - corruption was detected, the walk was stopped at the
+ *              first invalid block
+ * @details     The physical block chain, block sizes and free list links are
+ *              validated. The whole heap is walked under the core lock, use
+ *              @ref nheap_check() where latency matters.
+ * @api
+ */
+bool nheap_walk(
+    struct nheap *              heap,
+    void                     (* fn)(void *, void *, size_t, bool),
+    void *                      arg);
+
+
+
+#if (CONFIG_HEAP_CHECK == 1) || defined(__DOXYGEN__)
+/**@brief       Validate a limited number of heap blocks
+ * @param       heap
+ *              Pointer to heap structure instance
+ * @param       nblocks
+ *              Maximum number of blocks to validate in this call
+ * @return      Heap state:
+ *  @retval     true - the checked blocks are consistent
+ *  @retval     false - corruption was detected
+ * @details     Checking continues where the previous call stopped and wraps
+ *              around at the end of the heap. Since the cost is bounded by
+ *              @c nblocks the function is suitable for an idle hook.
+ * @iclass
+ */
+bool nheap_check_i(
+    struct nheap *              heap,
+    uint_fast16_t               nblocks);
+
+
+
+/**@brief       Validate a limited number of heap blocks
+ * @param       heap
+ *              Pointer to heap structure instance
+ * @param       nblocks
+ *              Maximum number of blocks to validate in this call
+ * @return      Heap state, see @ref nheap_check_i().
+ * @api
+ */
+bool nheap_check(
+    struct nheap *              heap,
+    uint_fast16_t               nblocks);
+#endif
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
 #endif
 
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if ((CONFIG_HEAP_FRONTEND != 0) && (CONFIG_HEAP_FRONTEND != 1))
+# error "Neon::Kernel::Heap: Configuration option CONFIG_HEAP_FRONTEND is out of range."
+#endif
+
+#if ((CONFIG_HEAP_OFFSET_LINKS != 0) && (CONFIG_HEAP_OFFSET_LINKS != 1))
+# error "Neon::Kernel::Heap: Configuration option CONFIG_HEAP_OFFSET_LINKS is out of range."
+#endif
+
+#if ((CONFIG_HEAP_CHECK != 0) && (CONFIG_HEAP_CHECK != 1))
+# error "Neon::Kernel::Heap: Configuration option CONFIG_HEAP_CHECK is out of range."
+#endif
+
+#if ((CONFIG_HEAP_CANARY != 0) && (CONFIG_HEAP_CANARY != 1))
+# error "Neon::Kernel::Heap: Configuration option CONFIG_HEAP_CANARY is out of range."
+#endif
+
+#if (CONFIG_HEAP_FRONTEND == 1) && (CONFIG_HEAP_OFFSET_LINKS == 1)
+# error "Neon::Kernel::Heap: CONFIG_HEAP_FRONTEND can't be used with CONFIG_HEAP_OFFSET_LINKS."
+#endif
+
+#if (CONFIG_HEAP_FRONTEND == 1)
+# if (CONFIG_HEAP_FE_GRANULE < 8u) || ((CONFIG_HEAP_FE_GRANULE & (CONFIG_HEAP_FE_GRANULE - 1u)) != 0u)
+#  error "Neon::Kernel::Heap: CONFIG_HEAP_FE_GRANULE must be a power of two, at least 8."
+# endif
+# if (CONFIG_HEAP_FE_CLASSES < 1u)
+#  error "Neon::Kernel::Heap: CONFIG_HEAP_FE_CLASSES must be at least 1."
+# endif
+# if (CONFIG_HEAP_FE_REFILL < 1u)
+#  error "Neon::Kernel::Heap: CONFIG_HEAP_FE_REFILL must be at least 1."
+# endif
+#endif
+
 /** @endcond *//** @} *//******************************************************
  * END of heap.h
  ******************************************************************************/
@@ -0,0 +1,141 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Persistent file backed heap
+ * @details     Maps a file into memory and runs a heap over it. The heap uses
+ *              offset links so the file can be mapped at a different address
+ *              after restart. Available on POSIX hosts only.
+ * @defgroup    mem_heap_file Persistent file backed heap
+ * @brief       Persistent file backed heap
+ *********************************************************************//** @{ */
+
+#ifndef NEON_MEM_HEAP_FILE_H_
+#define NEON_MEM_HEAP_FILE_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+
+#include "mm/heap.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Heap file open results
+ * @{ */
+#define NHEAP_FILE_ERROR                (-1)    /**<@brief OS error, see errno*/
+#define NHEAP_FILE_ATTACHED             0       /**<@brief Existing heap used */
+#define NHEAP_FILE_CREATED              1       /**<@brief New heap created   */
+#define NHEAP_FILE_RECREATED            2       /**<@brief Heap in file was not
+                                                 *         consistent and it was
+                                                 *         created again      */
+/** @} */
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       File backed heap instance
+ * @api
+ */
+struct nheap_file
+{
+    struct nheap                heap;           /**<@brief Heap instance      */
+    void *                      storage;        /**<@brief Mapped file        */
+    size_t                      size;           /**<@brief Mapped size        */
+    int                         fd;             /**<@brief File descriptor    */
+};
+
+/**@brief       File backed heap instance type
+ * @api
+ */
+typedef struct nheap_file nheap_file;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Open a file backed heap
+ * @param       heap_file
+ *              Pointer to file backed heap instance
+ * @param       path
+ *              Path to heap file. The file is created if it does not exist.
+ * @param       size
+ *              Size of heap in bytes.
+ * @return      One of heap file open results:
+ *              - @ref NHEAP_FILE_ATTACHED - the heap in file passed the
+ *                consistency check and its data is available through
+ *                @ref nheap_get_root().
+ *              - @ref NHEAP_FILE_CREATED - the file was new or of different
+ *                size, an empty heap was created.
+ *              - @ref NHEAP_FILE_RECREATED - the heap in file failed the
+ *                consistency check, an empty heap was created.
+ *              - @ref NHEAP_FILE_ERROR - the file could not be opened or
+ *                mapped.
+ * @details     On success the heap is used through @c heap_file->heap member
+ *              with the usual heap functions.
+ * @api
+ */
+int nheap_file_open(
+    struct nheap_file *         heap_file,
+    const char *                path,
+    size_t                      size);
+
+
+
+/**@brief       Write heap changes to the file
+ * @param       heap_file
+ *              Pointer to file backed heap instance
+ * @return      Zero on success, @ref NHEAP_FILE_ERROR otherwise.
+ * @api
+ */
+int nheap_file_sync(
+    struct nheap_file *         heap_file);
+
+
+
+/**@brief       Write heap changes to the file and close it
+ * @param       heap_file
+ *              Pointer to file backed heap instance
+ * @api
+ */
+void nheap_file_close(
+    struct nheap_file *         heap_file);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if (CONFIG_HEAP_OFFSET_LINKS != 1)
+# error "Neon::Kernel::Heap: File backed heap requires CONFIG_HEAP_OFFSET_LINKS."
+#endif
+
+/** @endcond *//** @} *//******************************************************
+ * END of heap_file.h
+ ******************************************************************************/
+#endif /* NEON_MEM_HEAP_FILE_H_ */
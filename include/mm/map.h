@@ -0,0 +1,220 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Mapped backing storage for memory allocators
+ * @details     Obtains allocator storage directly from the OS using @c mmap,
+ *              with optional huge pages, NUMA node binding and pre-faulting.
+ *              Available on Linux hosts only.
+ * @defgroup    mem_map Mapped backing storage
+ * @brief       Mapped backing storage
+ *********************************************************************//** @{ */
+
+#ifndef NEON_MEM_MAP_H_
+#define NEON_MEM_MAP_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mm/heap.h"
+#include "mm/pool.h"
+#include "mm/static.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Size of explicit and transparent huge pages
+ * @details     Mapping size is rounded up to this size when huge pages are
+ *              requested.
+ */
+#if !defined(CONFIG_MEM_MAP_HUGE_PAGE_SIZE)
+#define CONFIG_MEM_MAP_HUGE_PAGE_SIZE   (2ul * 1024ul * 1024ul)
+#endif
+
+/**@brief       Mapping attributes
+ * @details     When requesting a mapping these are hints. After the mapping is
+ *              done @ref nmem_map::attr holds only the attributes which were
+ *              actually obtained.
+ * @{ */
+#define NMEM_MAP_HUGE                   (0x1u << 0)     /**<@brief Explicit huge pages (hugetlbfs)  */
+#define NMEM_MAP_THP_ADVISE             (0x1u << 1)     /**<@brief Transparent huge pages advised,
+                                                         *  the kernel may still back the
+                                                         *  mapping with normal pages   */
+#define NMEM_MAP_NODE                   (0x1u << 2)     /**<@brief Bind to a NUMA node              */
+#define NMEM_MAP_PREFAULT               (0x1u << 3)     /**<@brief Fault in all pages in advance    */
+/** @} */
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Mapped storage descriptor
+ * @api
+ */
+struct nmem_map
+{
+    void *                      storage;        /**<@brief Mapped storage     */
+    size_t                      size;           /**<@brief Mapped size        */
+    uint32_t                    attr;           /**<@brief Obtained attributes*/
+};
+
+/**@brief       Mapped storage descriptor type
+ * @api
+ */
+typedef struct nmem_map nmem_map;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Map storage memory
+ * @param       map
+ *              Pointer to mapped storage descriptor
+ * @param       size
+ *              Requested size in bytes. It is rounded up to page size or to
+ *              @ref CONFIG_MEM_MAP_HUGE_PAGE_SIZE when huge pages are requested.
+ * @param       attr
+ *              Requested mapping attributes, see @ref NMEM_MAP_HUGE and
+ *              others.
+ * @param       node
+ *              NUMA node number, used only when @ref NMEM_MAP_NODE is
+ *              requested.
+ * @return      Mapping state:
+ *  @retval     true - storage is mapped, @c map->attr holds the attributes
+ *              which were obtained.
+ *  @retval     false - storage could not be mapped.
+ * @details     When explicit huge pages are not available the function falls
+ *              back to normal pages. Node binding is applied before
+ *              pre-faulting so the pages are placed on the requested node.
+ * @api
+ */
+bool nmem_map_alloc(
+    struct nmem_map *           map,
+    size_t                      size,
+    uint32_t                    attr,
+    uint_fast8_t                node);
+
+
+
+/**@brief       Unmap storage memory
+ * @param       map
+ *              Pointer to mapped storage descriptor
+ * @details     The allocator using this storage must be terminated first.
+ * @api
+ */
+void nmem_map_free(
+    struct nmem_map *           map);
+
+
+
+/**@brief       Initializes heap instance in mapped storage
+ * @param       heap
+ *              Pointer to heap instance
+ * @param       map
+ *              Pointer to mapped storage descriptor
+ * @param       size
+ *              Requested heap size in bytes
+ * @param       attr
+ *              Requested mapping attributes
+ * @param       node
+ *              NUMA node number
+ * @return      Mapping state, see @ref nmem_map_alloc().
+ * @api
+ */
+bool nheap_init_mapped(
+    struct nheap *              heap,
+    struct nmem_map *           map,
+    size_t                      size,
+    uint32_t                    attr,
+    uint_fast8_t                node);
+
+
+
+/**@brief       Initializes pool instance in mapped storage
+ * @param       pool
+ *              Pointer to pool instance
+ * @param       map
+ *              Pointer to mapped storage descriptor
+ * @param       array_size
+ *              Requested pool size in bytes
+ * @param       block_size
+ *              The size of one block expressed in bytes
+ * @param       attr
+ *              Requested mapping attributes
+ * @param       node
+ *              NUMA node number
+ * @return      Mapping state, see @ref nmem_map_alloc().
+ * @details     The pool uses the whole mapped size, which may be bigger than
+ *              requested size after rounding.
+ * @api
+ */
+bool npool_init_mapped(
+    struct npool *              pool,
+    struct nmem_map *           map,
+    size_t                      array_size,
+    size_t                      block_size,
+    uint32_t                    attr,
+    uint_fast8_t                node);
+
+
+
+/**@brief       Initializes static memory instance in mapped storage
+ * @param       static_mem
+ *              Pointer to static memory instance
+ * @param       map
+ *              Pointer to mapped storage descriptor
+ * @param       size
+ *              Requested size in bytes
+ * @param       attr
+ *              Requested mapping attributes
+ * @param       node
+ *              NUMA node number
+ * @return      Mapping state, see @ref nmem_map_alloc().
+ * @api
+ */
+bool nstatic_init_mapped(
+    struct nstatic *            static_mem,
+    struct nmem_map *           map,
+    size_t                      size,
+    uint32_t                    attr,
+    uint_fast8_t                node);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if ((CONFIG_MEM_MAP_HUGE_PAGE_SIZE & (CONFIG_MEM_MAP_HUGE_PAGE_SIZE - 1ul)) != 0ul)
+# error "Neon::Kernel::Map: Configuration option CONFIG_MEM_MAP_HUGE_PAGE_SIZE must be a power of two."
+#endif
+
+/** @endcond *//** @} *//******************************************************
+ * END of map.h
+ ******************************************************************************/
+#endif /* NEON_MEM_MAP_H_ */
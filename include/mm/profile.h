@@ -0,0 +1,235 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Memory allocation profiling
+ * @defgroup    mem_profile Memory allocation profiling
+ * @brief       Memory allocation profiling
+ *********************************************************************//** @{ */
+
+#ifndef NEON_MEM_PROFILE_H_
+#define NEON_MEM_PROFILE_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "port/compiler.h"
+#include "misc/stamp.h"
+#include "misc/trace.h"
+#include "mm/mem.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Enable allocation profiling
+ * @details     When enabled, every allocation and deallocation made through
+ *              the public memory API records caller address, size and
+ *              latency into a ring buffer. When disabled, the profiling hooks
+ *              expand to nothing.
+ * @api
+ */
+#if !defined(CONFIG_MEM_PROFILE)
+#define CONFIG_MEM_PROFILE              0
+#endif
+
+/**@brief       Number of records in profiling ring buffer
+ * @details     Must be a power of two.
+ * @api
+ */
+#if !defined(CONFIG_MEM_PROFILE_RECORDS)
+#define CONFIG_MEM_PROFILE_RECORDS      256u
+#endif
+
+/**@brief       Get the address of the caller of current function
+ * @api
+ */
+#if !defined(CONFIG_MEM_PROFILE_CALLER)
+# if defined(__GNUC__)
+#  define CONFIG_MEM_PROFILE_CALLER()   __builtin_return_address(0)
+# else
+#  define CONFIG_MEM_PROFILE_CALLER()   (NULL)
+# endif
+#endif
+
+/**@brief       Number of buckets in size histogram
+ * @api
+ */
+#define NMEM_PROFILE_SIZE_BUCKETS       16u
+
+/**@brief       Profiling record operations
+ * @{ */
+#define NMEM_PROFILE_ALLOC              0u
+#define NMEM_PROFILE_FAIL               1u
+#define NMEM_PROFILE_FREE               2u
+/** @} */
+
+/**@brief       Profiling hooks
+ * @details     The hooks are placed in public allocator functions. The
+ *              @c _I hooks must be called with the core lock held. They also
+ *              emit memory trace events when @ref CONFIG_TRACE is enabled.
+ * @notapi
+ * @{ */
+#if (CONFIG_MEM_PROFILE == 1)
+#define NMEM_PROFILE_BEGIN(stamp)                                               \
+    nstamp stamp = nstamp_get()
+
+#define NMEM_PROFILE_ALLOC_I(mem, size, storage, stamp)                         \
+    do {                                                                        \
+        nmem_profile_record_i(                                                  \
+            (mem),                                                              \
+            (storage) != NULL ? NMEM_PROFILE_ALLOC : NMEM_PROFILE_FAIL,         \
+            CONFIG_MEM_PROFILE_CALLER(),                                        \
+            (size),                                                             \
+            (stamp));                                                           \
+        NTRACE(NTRACE_MEM_ALLOC, (mem), (size));                                \
+    } while (0)
+
+#define NMEM_PROFILE_FREE_I(mem, stamp)                                         \
+    do {                                                                        \
+        nmem_profile_record_i(                                                  \
+            (mem),                                                              \
+            NMEM_PROFILE_FREE,                                                  \
+            CONFIG_MEM_PROFILE_CALLER(),                                        \
+            0u,                                                                 \
+            (stamp));                                                           \
+        NTRACE(NTRACE_MEM_FREE, (mem), 0u);                                     \
+    } while (0)
+#else
+#define NMEM_PROFILE_BEGIN(stamp)       (void)0
+#define NMEM_PROFILE_ALLOC_I(mem, size, storage, stamp)                         \
+    NTRACE(NTRACE_MEM_ALLOC, (mem), (size))
+#define NMEM_PROFILE_FREE_I(mem, stamp)                                         \
+    NTRACE(NTRACE_MEM_FREE, (mem), 0u)
+#endif
+/** @} */
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Aggregated allocation statistics of one call site
+ * @api
+ */
+struct nmem_profile_site
+{
+    const void *                caller;         /**<@brief Call site address  */
+    uint32_t                    allocs;         /**<@brief Allocations        */
+    uint32_t                    failures;       /**<@brief Failed allocations */
+    uint32_t                    frees;          /**<@brief Deallocations      */
+    size_t                      bytes;          /**<@brief Requested bytes    */
+    nstamp                      latency_total;  /**<@brief Summed latency     */
+    nstamp                      latency_max;    /**<@brief Maximum latency    */
+};
+
+/**@brief       Allocation statistics dump
+ * @api
+ */
+struct nmem_profile_dump
+{
+    struct nmem_profile_site *  site;           /**<@brief Call site table    */
+    size_t                      site_size;      /**<@brief Call site capacity */
+    size_t                      site_count;     /**<@brief Used call sites    */
+    uint32_t                    dropped;        /**<@brief Records with no site
+                                                 *         slot available     */
+    uint32_t                    size_hist[NMEM_PROFILE_SIZE_BUCKETS];
+                                                /**<@brief Log2 size histogram*/
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+#if (CONFIG_MEM_PROFILE == 1) || defined(__DOXYGEN__)
+
+/**@brief       Record one allocator call
+ * @param       mem
+ *              Memory instance which was called.
+ * @param       op
+ *              Operation, one of @ref NMEM_PROFILE_ALLOC, @ref NMEM_PROFILE_FAIL
+ *              or @ref NMEM_PROFILE_FREE.
+ * @param       caller
+ *              Address of the call site.
+ * @param       size
+ *              Requested size in bytes.
+ * @param       begin
+ *              Time stamp taken before the allocator call.
+ * @details     The ring buffer has a single writer which always runs with the
+ *              core lock held, so recording does not take any additional lock.
+ * @iclass
+ */
+void nmem_profile_record_i(
+    const struct nmem *         mem,
+    uint_fast8_t                op,
+    const void *                caller,
+    size_t                      size,
+    nstamp                      begin);
+
+
+
+/**@brief       Aggregate recorded calls by call site and size
+ * @param       mem
+ *              Memory instance to report about. When NULL all instances are
+ *              reported.
+ * @param       dump
+ *              Pointer to dump structure. Members @c site and @c site_size
+ *              must be set by caller, other members are filled in.
+ * @details     The ring buffer is read without taking the core lock. Records
+ *              that are overwritten while being read are skipped.
+ * @api
+ */
+void nmem_profile_dump(
+    const struct nmem *         mem,
+    struct nmem_profile_dump *  dump);
+
+
+
+/**@brief       Discard all recorded calls
+ * @api
+ */
+void nmem_profile_clear(void);
+
+#endif /* (CONFIG_MEM_PROFILE == 1) */
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if ((CONFIG_MEM_PROFILE != 0) && (CONFIG_MEM_PROFILE != 1))
+# error "Neon::Kernel::Memory: Configuration option CONFIG_MEM_PROFILE is out of range."
+#endif
+
+#if ((CONFIG_MEM_PROFILE_RECORDS & (CONFIG_MEM_PROFILE_RECORDS - 1u)) != 0u) || \
+    (CONFIG_MEM_PROFILE_RECORDS < 2u)
+# error "Neon::Kernel::Memory: CONFIG_MEM_PROFILE_RECORDS must be a power of two."
+#endif
+
+/** @endcond *//** @} *//******************************************************
+ * END of profile.h
+ ******************************************************************************/
+#endif /* NEON_MEM_PROFILE_H_ */
@@ -0,0 +1,230 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Events and thread mailboxes
+ * @details     An event is a block of memory which starts with
+ *              @ref nevent structure. Events are passed between threads by
+ *              pointer, so the ownership of the event is transferred without
+ *              copying. Each thread has a FIFO mailbox of event pointers.
+ *
+ *              Posting an event to a thread also makes the thread ready, once
+ *              for each posted event. Fetching an event takes one readiness
+ *              away, so a thread stays in the run queue exactly as long as its
+ *              mailbox is not empty.
+ * @code
+ *              struct tick_event
+ *              {
+ *                  struct nevent       super;
+ *                  uint32_t            count;
+ *              };
+ *
+ *              static void consumer(void * arg)
+ *              {
+ *                  struct nevent *     event;
+ *
+ *                  event = nevent_fetch(nsched_get_current());
+ *                  ...
+ *                  nevent_release(event);
+ *              }
+ * @endcode
+ * @defgroup    sched_event Events
+ * @brief       Events and thread mailboxes
+ *********************************************************************//** @{ */
+
+#ifndef NEON_SCHED_EVENT_H_
+#define NEON_SCHED_EVENT_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "port/core.h"
+#include "shared/config.h"
+#include "mm/mem.h"
+#include "sched/sched.h"
+
+/*===============================================================  MACRO's  ==*/
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Event header
+ * @details     Must be the first member of application event structures.
+ * @api
+ */
+struct nevent
+{
+    struct nmem *               mem;            /**<@brief Owner allocator,
+                                                 *         NULL for static    */
+    uint16_t                    id;             /**<@brief Event identifier   */
+    uint16_t                    ref;            /**<@brief Reference count,
+                                                 *         unused for static  */
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_SCHED_EVENT == 1) || defined(__DOXYGEN__)
+
+
+/**@brief       Initialize a static event
+ * @details     Static events are never returned to an allocator and are not
+ *              reference counted, so they may be posted and published any
+ *              number of times without re-initialization. The application
+ *              must keep such an event unchanged until all receivers are done
+ *              with it.
+ * @api
+ */
+void nevent_init(
+    struct nevent *             event,
+    uint16_t                    id);
+
+
+
+/**@brief       Allocate an event
+ * @param       mem
+ *              Allocator, usually a pool (@c &pool->mem_class)
+ * @param       size
+ *              Size of the whole event, at least sizeof(struct nevent)
+ * @param       id
+ *              Event identifier
+ * @return      Pointer to event or NULL if allocator is exhausted.
+ * @iclass
+ */
+struct nevent * nevent_create_i(
+    struct nmem *               mem,
+    size_t                      size,
+    uint16_t                    id);
+
+
+
+/**@brief       Allocate an event
+ * @api
+ */
+struct nevent * nevent_create(
+    struct nmem *               mem,
+    size_t                      size,
+    uint16_t                    id);
+
+
+
+/**@brief       Drop a reference to an event
+ * @details     A new event has one reference. The event returns to its
+ *              allocator when the last reference is dropped. Does nothing for
+ *              static events.
+ * @iclass
+ */
+void nevent_release_i(
+    struct nevent *             event);
+
+
+
+/**@brief       Drop a reference to an event
+ * @api
+ */
+void nevent_release(
+    struct nevent *             event);
+
+
+
+/**@brief       Post an event to a thread mailbox
+ * @param       thread
+ *              Receiving thread
+ * @param       event
+ *              Event, ownership is transferred to the receiver
+ * @return      Posting status
+ *  @retval     true - event is in the mailbox and the thread is made ready
+ *  @retval     false - mailbox is full, the caller still owns the event
+ * @iclass
+ */
+bool nevent_post_i(
+    struct nthread *            thread,
+    struct nevent *             event);
+
+
+
+/**@brief       Post an event to a thread mailbox
+ * @api
+ */
+bool nevent_post(
+    struct nthread *            thread,
+    struct nevent *             event);
+
+
+
+/**@brief       Fetch the oldest event from a thread mailbox
+ * @param       thread
+ *              Receiving thread, usually the current thread
+ * @return      Pointer to event or NULL if the mailbox is empty. The caller
+ *              owns the event and must release it when done.
+ * @iclass
+ */
+struct nevent * nevent_fetch_i(
+    struct nthread *            thread);
+
+
+
+/**@brief       Fetch the oldest event from a thread mailbox
+ * @api
+ */
+struct nevent * nevent_fetch(
+    struct nthread *            thread);
+
+
+
+/**@brief       Put an event into a thread mailbox without making it ready
+ * @details     The caller must make the thread ready, once for each event.
+ *              Used for fan-out, where the caller first checks whether the
+ *              mailbox accepted the event.
+ * @notapi
+ */
+bool nevent_mailbox_push_i(
+    struct nthread *            thread,
+    struct nevent *             event);
+
+
+
+/**@brief       Release all events left in a mailbox of a thread
+ * @details     Called by the scheduler when a thread is terminated.
+ * @notapi
+ */
+void nevent_mailbox_term_i(
+    struct nthread *            thread);
+
+#endif /* (CONFIG_SCHED_EVENT == 1) */
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of event.h
+ ******************************************************************************/
+#endif /* NEON_SCHED_EVENT_H_ */
@@ -0,0 +1,74 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Dispatcher idle hook for Linux hosts
+ * @details     Blocks the dispatcher on an eventfd until a thread becomes ready
+ *              or the next virtual timer is due, instead of spinning.
+ * @defgroup    sched_host_idle Host idle hook
+ * @brief       Host idle hook
+ *********************************************************************//** @{ */
+
+#ifndef NEON_SCHED_HOST_IDLE_H_
+#define NEON_SCHED_HOST_IDLE_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdbool.h>
+
+/*===============================================================  MACRO's  ==*/
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Install host idle and wake hooks into the scheduler
+ * @return      Installation state:
+ *  @retval     true - hooks are installed
+ *  @retval     false - eventfd could not be created, see errno
+ * @api
+ */
+bool nsched_host_idle_init(void);
+
+
+
+/**@brief       Remove host idle hooks from the scheduler
+ * @details     Must not be called while @ref nsched_run() is running.
+ * @api
+ */
+void nsched_host_idle_term(void);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of host_idle.h
+ ******************************************************************************/
+#endif /* NEON_SCHED_HOST_IDLE_H_ */
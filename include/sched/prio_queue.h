@@ -263,6 +263,9 @@ void nprio_queue_remove(
         nbitmap_clear(&queue->bitmap, bucket);                                  /* Mark the bucket as unused.         */
 #endif
     } else {
+        if (queue->sentinel[bucket] == node) {                                  /* Do not leave sentinel pointing to  */
+            queue->sentinel[bucket] = nbias_list_next(node);                    /* the removed node.                  */
+        }
         nbias_list_remove(node);
     }
 }
@@ -309,6 +312,23 @@ struct nbias_list * nprio_queue_peek(
 
 
 
+/**@brief       Get the node which would be fetched next from a bucket
+ * @return      Pointer to node or NULL if the bucket is empty.
+ */
+PORT_C_INLINE
+struct nbias_list * nprio_queue_peek_bucket(
+    const struct nprio_queue *  queue,
+    uint_fast8_t                bucket)
+{
+    if (queue->sentinel[bucket] == NULL) {
+        return (NULL);
+    } else {
+        return (nbias_list_tail(queue->sentinel[bucket]));
+    }
+}
+
+
+
 PORT_C_INLINE
 bool nprio_queue_is_empty(
     const struct nprio_queue *  queue)
@@ -0,0 +1,150 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Publish/subscribe bus
+ * @details     Threads subscribe to topics. An event published to a topic is
+ *              not copied: the same event is put into the mailbox of every
+ *              subscriber and its reference count is raised once for each of
+ *              them. Each subscriber drops its reference with
+ *              @ref nevent_release() and the event returns to its pool when
+ *              the last subscriber is done with it. Static events are not
+ *              reference counted.
+ * @defgroup    sched_pubsub Publish/subscribe
+ * @brief       Publish/subscribe bus
+ *********************************************************************//** @{ */
+
+#ifndef NEON_SCHED_PUBSUB_H_
+#define NEON_SCHED_PUBSUB_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+
+#include "port/core.h"
+#include "shared/config.h"
+#include "shared/list.h"
+#include "sched/event.h"
+#include "sched/sched.h"
+
+/*===============================================================  MACRO's  ==*/
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Topic
+ * @api
+ */
+struct ntopic
+{
+    struct ndlist               subscribers;    /**<@brief Subscription list  */
+};
+
+/**@brief       Subscription of a thread to a topic
+ * @details     Memory for subscription is provided by the application. A
+ *              thread must be unsubscribed from all topics before it is
+ *              terminated.
+ * @api
+ */
+struct nsubscription
+{
+    struct ndlist               node;           /**<@brief Topic list node    */
+    struct nthread *            thread;         /**<@brief Subscriber         */
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_SCHED_EVENT == 1) || defined(__DOXYGEN__)
+
+
+/**@brief       Initialize a topic
+ * @api
+ */
+void ntopic_init(
+    struct ntopic *             topic);
+
+
+
+/**@brief       Subscribe a thread to a topic
+ * @param       topic
+ *              Pointer to topic
+ * @param       subscription
+ *              Pointer to subscription memory
+ * @param       thread
+ *              Subscriber
+ * @api
+ */
+void ntopic_subscribe(
+    struct ntopic *             topic,
+    struct nsubscription *      subscription,
+    struct nthread *            thread);
+
+
+
+/**@brief       Cancel a subscription
+ * @api
+ */
+void ntopic_unsubscribe(
+    struct nsubscription *      subscription);
+
+
+
+/**@brief       Publish an event to all subscribers of a topic
+ * @param       topic
+ *              Pointer to topic
+ * @param       event
+ *              Event, the reference of the caller is consumed
+ * @return      Number of subscribers which received the event. Subscribers
+ *              with full mailbox miss the event.
+ * @details     When no subscriber received the event it is released.
+ * @iclass
+ */
+size_t ntopic_publish_i(
+    struct ntopic *             topic,
+    struct nevent *             event);
+
+
+
+/**@brief       Publish an event to all subscribers of a topic
+ * @api
+ */
+size_t ntopic_publish(
+    struct ntopic *             topic,
+    struct nevent *             event);
+
+#endif /* (CONFIG_SCHED_EVENT == 1) */
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+/** @endcond *//** @} *//******************************************************
+ * END of pubsub.h
+ ******************************************************************************/
+#endif /* NEON_SCHED_PUBSUB_H_ */
@@ -0,0 +1,170 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Thread registry
+ * @details     Keeps all initialized threads in a hash table keyed by thread
+ *              name and in a list for iteration. Threads are linked by
+ *              nsched_thread_init() and unlinked by nsched_thread_term().
+ * @defgroup    sched_registry Thread registry
+ * @brief       Thread registry
+ *********************************************************************//** @{ */
+
+#ifndef NEON_SCHED_REGISTRY_H_
+#define NEON_SCHED_REGISTRY_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+
+#include "shared/config.h"
+#include "shared/list.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Number of hash buckets in thread registry
+ * @details     Must be a power of two.
+ * @api
+ */
+#if !defined(CONFIG_REGISTRY_BUCKETS)
+#define CONFIG_REGISTRY_BUCKETS         16u
+#endif
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+struct nthread;
+
+/**@brief       Registry iterator
+ * @details     An active iterator is known to the registry. When the thread
+ *              it would return next is unlinked, the iterator is moved to the
+ *              following thread, so iteration never touches a terminated
+ *              thread and the core lock is held only for one step.
+ * @api
+ */
+struct nregistry_iter
+{
+    struct ndlist               node;           /**<@brief Active iterators   */
+    struct nthread *            next;           /**<@brief Next thread        */
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_REGISTRY == 1) || defined(__DOXYGEN__)
+
+
+/**@brief       Initialize thread registry
+ * @details     Called by nsched_init().
+ * @notapi
+ */
+void nregistry_init(void);
+
+
+
+/**@brief       Link a thread into registry
+ * @notapi
+ */
+void nregistry_link_i(
+    struct nthread *            thread);
+
+
+
+/**@brief       Unlink a thread from registry
+ * @notapi
+ */
+void nregistry_unlink_i(
+    struct nthread *            thread);
+
+
+
+/**@brief       Find a thread by name
+ * @param       name
+ *              Thread name. Only the first @ref CONFIG_REGISTRY_NAME_SIZE
+ *              characters are compared.
+ * @return      Pointer to thread, or NULL when no thread has that name. When
+ *              more threads share a name, the one registered first is
+ *              returned.
+ * @details     Lookup time depends only on the number of threads in one hash
+ *              bucket.
+ * @api
+ */
+struct nthread * nregistry_find(
+    const char *                name);
+
+
+
+/**@brief       Start iteration over all registered threads
+ * @param       iter
+ *              Pointer to iterator
+ * @api
+ */
+void nregistry_iter_begin(
+    struct nregistry_iter *     iter);
+
+
+
+/**@brief       Get next registered thread
+ * @param       iter
+ *              Pointer to iterator
+ * @return      Pointer to thread, or NULL at the end of iteration. At the end
+ *              the iterator is ended, too.
+ * @details     Threads are returned in registration order. A thread which is
+ *              registered during iteration may or may not be returned.
+ * @api
+ */
+struct nthread * nregistry_iter_next(
+    struct nregistry_iter *     iter);
+
+
+
+/**@brief       End iteration before reaching the end
+ * @param       iter
+ *              Pointer to iterator
+ * @details     Calling it on an iterator which has already ended is allowed.
+ * @api
+ */
+void nregistry_iter_end(
+    struct nregistry_iter *     iter);
+
+#endif /* (CONFIG_REGISTRY == 1) */
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if (CONFIG_REGISTRY_BUCKETS == 0u) ||                                          \
+    ((CONFIG_REGISTRY_BUCKETS & (CONFIG_REGISTRY_BUCKETS - 1u)) != 0u)
+# error "Neon::Kernel::Registry: CONFIG_REGISTRY_BUCKETS must be a power of two."
+#endif
+
+/** @endcond *//** @} *//******************************************************
+ * END of registry.h
+ ******************************************************************************/
+#endif /* NEON_SCHED_REGISTRY_H_ */
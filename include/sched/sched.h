@@ -31,10 +31,15 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <stddef.h>
+
 #include "port/core.h"
+#include "shared/bitop.h"
 #include "shared/config.h"
 #include "shared/bias_list.h"
 #include "shared/list.h"
+#include "misc/stamp.h"
+#include "misc/timer.h"
 
 /*===============================================================  MACRO's  ==*/
 
@@ -48,6 +53,158 @@
  */
 #define NTHREAD_PRIORITY_MIN            (0u)
 
+/**@brief       Enable earliest deadline first scheduling class
+ * @details     When enabled, threads with priority equal to
+ *              @ref CONFIG_SCHED_EDF_PRIORITY are not scheduled in FIFO order
+ *              but by their absolute deadline, see
+ *              @ref nsched_thread_set_deadline_i(). The whole EDF class competes
+ *              with fixed priority threads as a single entity at that
+ *              priority level.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_EDF)
+#define CONFIG_SCHED_EDF                0
+#endif
+
+/**@brief       Priority level of earliest deadline first scheduling class
+ * @api
+ */
+#if !defined(CONFIG_SCHED_EDF_PRIORITY)
+#define CONFIG_SCHED_EDF_PRIORITY       NTHREAD_PRIORITY_MAX
+#endif
+
+/**@brief       Enable weighted round-robin within a priority level
+ * @details     When enabled, each thread has a weight. A thread which is
+ *              fetched keeps the head of its priority level for @c weight
+ *              consecutive dispatches before it is rotated (deficit round
+ *              robin with one dispatch as quantum). Threads with weight 0 or 1
+ *              behave as in plain round-robin.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_WEIGHTED)
+#define CONFIG_SCHED_WEIGHTED           0
+#endif
+
+/**@brief       Enable priority aging
+ * @details     When enabled, each aging step picks a ready thread below the
+ *              highest ready priority and boosts it to that priority. The
+ *              boosted thread drops back to its own priority when it is
+ *              dispatched. Priority levels are visited in turn, from higher
+ *              to lower, so every waiting level is eventually served.
+ *
+ *              Aging steps are made every @ref CONFIG_SCHED_AGING_PERIOD
+ *              dispatches and on each call of @ref nsched_age_i(), which can
+ *              be called from a periodic virtual timer for tick based aging.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_AGING)
+#define CONFIG_SCHED_AGING              0
+#endif
+
+/**@brief       Number of dispatches between two aging steps
+ * @details     Value 0 disables dispatch based aging, so only
+ *              @ref nsched_age_i() makes aging steps.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_AGING_PERIOD)
+#define CONFIG_SCHED_AGING_PERIOD       16u
+#endif
+
+/**@brief       Enable per-thread run time accounting
+ * @details     When enabled, each thread records dispatch count, run time and
+ *              ready-to-run latency measured with @ref nstamp_get(). The data
+ *              is read with @ref nsched_thread_stats().
+ * @api
+ */
+#if !defined(CONFIG_SCHED_STATS)
+#define CONFIG_SCHED_STATS              0
+#endif
+
+/**@brief       Number of log2 buckets in ready-to-run latency histogram
+ * @api
+ */
+#if !defined(CONFIG_SCHED_STATS_BUCKETS)
+#define CONFIG_SCHED_STATS_BUCKETS      16u
+#endif
+
+/**@brief       Enable run budget watchdog
+ * @details     When enabled, @ref nsched_run() arms a virtual timer with the
+ *              thread run budget before each dispatch and records the thread
+ *              as an offender when the budget is exceeded, see
+ *              @ref sched_watchdog.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_WATCHDOG)
+#define CONFIG_SCHED_WATCHDOG           0
+#endif
+
+/**@brief       Number of offenders kept by run budget watchdog
+ * @api
+ */
+#if !defined(CONFIG_SCHED_WATCHDOG_OFFENDERS)
+#define CONFIG_SCHED_WATCHDOG_OFFENDERS 8u
+#endif
+
+/**@brief       Enable synchronization objects
+ * @details     When enabled, each thread gets a wait queue node and a timeout
+ *              timer which are used by semaphores, mutexes and event flags,
+ *              see @ref sched_sync.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_SYNC)
+#define CONFIG_SCHED_SYNC               0
+#endif
+
+/**@brief       Enable per-thread event mailboxes
+ * @details     When enabled, each thread has a FIFO mailbox of event pointers,
+ *              see @ref sched_event.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_EVENT)
+#define CONFIG_SCHED_EVENT              0
+#endif
+
+/**@brief       Number of events a thread mailbox can hold
+ * @details     Must be a power of two.
+ * @api
+ */
+#if !defined(CONFIG_SCHED_EVENT_MAILBOX_SIZE)
+#define CONFIG_SCHED_EVENT_MAILBOX_SIZE 8u
+#endif
+
+/**@brief       Define a static thread table
+ * @param       table
+ *              Name of table. It is also used as prefix for generated arrays:
+ *              @c table_define and @c table_thread.
+ * @param       ...
+ *              Thread definitions, each one an initializer of
+ *              @ref nthread_define.
+ * @details     Thread definitions are placed into constant memory and thread
+ *              structures into zero initialized memory, so the table costs no
+ *              initialized data. All threads are initialized and started at
+ *              run time with one call of @ref nsched_thread_table_start().
+ * @code
+ *              NTHREAD_TABLE_DEFINE(g_app_threads,
+ *                  { .name = "rx", .priority = 10, .entry = rx_run },
+ *                  { .name = "tx", .priority = 9,  .entry = tx_run });
+ * @endcode
+ * @api
+ */
+#define NTHREAD_TABLE_DEFINE(table, ...)                                        \
+    static const struct nthread_define table ## _define[] = { __VA_ARGS__ };    \
+    static struct nthread table ## _thread[NARRAY_DIMENSION(table ## _define)]; \
+    static const struct nthread_table table = {                                 \
+        table ## _define,                                                       \
+        table ## _thread,                                                       \
+        NARRAY_DIMENSION(table ## _define)                                      \
+    }
+
+/**@brief       Get thread from a static thread table
+ * @api
+ */
+#define NTHREAD_TABLE_THREAD(table, index)                                      \
+    (&table ## _thread[(index)])
+
 /*-------------------------------------------------------  C++ extern base  --*/
 #ifdef __cplusplus
 extern "C" {
@@ -55,25 +212,107 @@ extern "C" {
 
 /*============================================================  DATA TYPES  ==*/
 
+struct nevent;
+
 struct nthread_define
 {
     const char *                name;
     uint8_t                     priority;
+    void                     (* entry)(void *);     /**<@brief Run function   */
+    void *                      arg;                /**<@brief Run argument   */
+#if (CONFIG_SCHED_WEIGHTED == 1) || defined(__DOXYGEN__)
+    uint8_t                     weight;             /**<@brief Dispatch weight*/
+#endif
+#if (CONFIG_SCHED_WATCHDOG == 1) || defined(__DOXYGEN__)
+    ncore_time_tick             budget;             /**<@brief Run budget in
+                                                     *   ticks, 0 - unlimited */
+#endif
 };
 
+#if (CONFIG_SCHED_STATS == 1) || defined(__DOXYGEN__)
+/**@brief       Thread run time statistics
+ * @api
+ */
+struct nthread_stats
+{
+    uint32_t                    dispatches;     /**<@brief Number of runs     */
+    uint64_t                    run_total;      /**<@brief Summed run time    */
+    nstamp                      run_max;        /**<@brief Longest run time   */
+    nstamp                      latency_max;    /**<@brief Longest wait time  */
+    uint32_t                    latency_hist[CONFIG_SCHED_STATS_BUCKETS];       /**<@brief Wait time log2 histogram   */
+};
+#endif
+
 struct nthread
 {
     struct nbias_list           node;           /**<@brief Priority queue node*/
     ncpu_reg                    ref;            /**<@brief Reference count    */
+    void                     (* entry)(void *); /**<@brief Run function       */
+    void *                      arg;            /**<@brief Run argument       */
+#if (CONFIG_SCHED_AGING == 1) || defined(__DOXYGEN__)
+    uint_fast8_t                base_priority;  /**<@brief Priority without
+                                                 *         aging boost        */
+#endif
+#if (CONFIG_SCHED_WEIGHTED == 1) || defined(__DOXYGEN__)
+    uint_fast8_t                weight;         /**<@brief Dispatch weight    */
+    uint_fast8_t                credit;         /**<@brief Dispatches left    */
+#endif
+#if (CONFIG_SCHED_EDF == 1) || defined(__DOXYGEN__)
+    struct ndlist               edf_node;       /**<@brief EDF queue node     */
+    ncore_time_tick             deadline;       /**<@brief Absolute deadline  */
+#endif
+#if (CONFIG_SCHED_WATCHDOG == 1) || defined(__DOXYGEN__)
+    ncore_time_tick             budget;         /**<@brief Run budget         */
+#endif
+#if (CONFIG_SCHED_STATS == 1) || defined(__DOXYGEN__)
+    struct nthread_stats        stats;          /**<@brief Run statistics     */
+    nstamp                      ready_stamp;    /**<@brief Became ready at    */
+#endif
+#if (CONFIG_SCHED_SYNC == 1) || defined(__DOXYGEN__)
+    struct nbias_list           wait_node;      /**<@brief Wait queue node    */
+    struct nprio_queue *        wait_queue;     /**<@brief Queue of the object
+                                                 *         being waited on    */
+    struct ntimer               wait_timer;     /**<@brief Timeout timer      */
+    uint32_t                    wait_flags;     /**<@brief Event flags mask   */
+    ncpu_reg                    parked_ref;     /**<@brief Reference count
+                                                 *         kept while parked  */
+    bool                        is_parked;      /**<@brief Off the run queue
+                                                 *         while it waits     */
+    uint8_t                     wait_mode;      /**<@brief Event flags mode   */
+    uint8_t                     wait_status;    /**<@brief Wait result        */
+    uint8_t                     wait_object;    /**<@brief Kind of object     */
+    struct ndlist               mutex_held;     /**<@brief Owned mutexes      */
+    struct ndlist               resource_held;  /**<@brief Owned resources    */
+    uint_fast8_t                own_priority;   /**<@brief Priority before
+                                                 *         resource raises    */
+#endif
+#if (CONFIG_SCHED_EVENT == 1) || defined(__DOXYGEN__)
+    struct nevent *             mailbox[CONFIG_SCHED_EVENT_MAILBOX_SIZE];      /**<@brief Event mailbox ring         */
+    uint8_t                     mailbox_head;   /**<@brief Oldest event index */
+    uint8_t                     mailbox_count;  /**<@brief Number of events   */
+#endif
 #if (CONFIG_REGISTRY == 1) || defined(__DOXYGEN__)
     char                        name[CONFIG_REGISTRY_NAME_SIZE];
-    struct ndlist               registry_node;
+    struct ndlist               registry_node;  /**<@brief Registry list node */
+    struct ndlist               registry_hash_node; /**<@brief Hash bucket node*/
+    uint32_t                    registry_hash;  /**<@brief Hash of name       */
 #endif
 #if (CONFIG_API_VALIDATION == 1) || defined(__DOXYGEN__)
     unsigned int                signature;
 #endif
 };
 
+/**@brief       Static thread table
+ * @details     Defined by @ref NTHREAD_TABLE_DEFINE.
+ * @api
+ */
+struct nthread_table
+{
+    const struct nthread_define * define;       /**<@brief Definitions        */
+    struct nthread *            thread;         /**<@brief Threads            */
+    size_t                      count;          /**<@brief Number of threads  */
+};
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*===================================================  FUNCTION PROTOTYPES  ==*/
 
@@ -92,6 +331,23 @@ void nsched_thread_init(
 
 
 
+/**@brief       Initialize and start all threads of a static thread table
+ * @param       table
+ *              Pointer to table defined by @ref NTHREAD_TABLE_DEFINE.
+ * @details     All threads are initialized first and then linked into the
+ *              registry and inserted into the run queue in a single critical
+ *              section.
+ * @note        The work done for each thread is the same as with
+ *              @ref nsched_thread_init() and @ref nsched_thread_insert_i(),
+ *              only the lock is taken once for the whole table. Thread and
+ *              run queue state is not pre-built at compile time.
+ * @api
+ */
+void nsched_thread_table_start(
+    const struct nthread_table * table);
+
+
+
 void nsched_thread_term(
     struct nthread *            thread);
 
@@ -113,12 +369,237 @@ struct nthread * nsched_thread_fetch_i(void);
 
 struct nthread * nsched_get_current(void);
 
+
+
+/**@brief       Run the dispatcher loop
+ * @details     Fetches ready threads and calls their entry function, until
+ *              @ref nsched_stop() is called. Each call of thread entry function
+ *              must run to completion and return. Thread entry functions are
+ *              called with the core lock released.
+ *
+ *              When there is no ready thread, the idle hook set by
+ *              @ref nsched_set_idle() is called. Without an idle hook the loop
+ *              polls the run queue.
+ * @api
+ */
+void nsched_run(void);
+
+
+
+/**@brief       Make the dispatcher loop return
+ * @details     The loop returns after the thread which is currently running
+ *              finishes. A dispatcher which is idle is woken up.
+ * @api
+ */
+void nsched_stop(void);
+
+
+
+/**@brief       Set dispatcher idle and wake hooks
+ * @param       idle
+ *              Called by @ref nsched_run() when there is no ready thread. It is
+ *              called with the core lock released and it may block until the
+ *              wake hook is called. Can be NULL.
+ * @param       wake
+ *              Called when a thread is inserted into an empty run queue and by
+ *              @ref nsched_stop(). It is called with the core lock held, so it
+ *              must only signal the idle hook. Can be NULL.
+ * @param       arg
+ *              Argument passed to both hooks.
+ * @details     A wake which happens after the run queue was found empty, but
+ *              before the idle hook blocked, must not be lost. The idle hook
+ *              should therefore wait on a latching primitive like an event
+ *              counter or wait-for-event instruction.
+ * @api
+ */
+void nsched_set_idle(
+    void                     (* idle)(void *),
+    void                     (* wake)(void *),
+    void *                      arg);
+
+
+
+#if (CONFIG_SCHED_EDF == 1) || defined(__DOXYGEN__)
+/**@brief       Set absolute deadline of EDF thread
+ * @param       thread
+ *              Pointer to thread which belongs to EDF scheduling class.
+ * @param       deadline
+ *              Absolute deadline in system ticks. Deadlines are compared with
+ *              wrap-around, so they must not be further apart than half of
+ *              the tick range.
+ * @details     If the thread is ready it is moved to the new position in EDF
+ *              queue.
+ * @iclass
+ */
+void nsched_thread_set_deadline_i(
+    struct nthread *            thread,
+    ncore_time_tick             deadline);
+#endif
+
+
+
+#if (CONFIG_SCHED_SYNC == 1) || defined(__DOXYGEN__)
+/**@brief       Park a thread, take it off the run queue regardless of its
+ *              reference count
+ * @param       thread
+ *              Pointer to thread
+ * @details     While a thread is parked insertions and removals only change
+ *              the kept reference count, the thread is not dispatched. Used
+ *              to block a thread on a synchronization object.
+ * @iclass
+ */
+void nsched_thread_park_i(
+    struct nthread *            thread);
+
+
+
+/**@brief       Unpark a thread parked by @ref nsched_thread_park_i()
+ * @param       thread
+ *              Pointer to thread
+ * @details     The thread is put back on the run queue when it has a kept
+ *              reference.
+ * @iclass
+ */
+void nsched_thread_unpark_i(
+    struct nthread *            thread);
+#endif
+
+
+
+/**@brief       Change priority of a thread
+ * @param       thread
+ *              Pointer to thread
+ * @param       priority
+ *              New priority, in range @ref NTHREAD_PRIORITY_MIN to
+ *              @ref NTHREAD_PRIORITY_MAX.
+ * @details     If the thread is ready it is moved to the tail of the new
+ *              priority level. The move costs one removal and one insertion
+ *              in the run queue bitmap. Any aging boost of the thread ends.
+ * @iclass
+ */
+void nsched_thread_set_priority_i(
+    struct nthread *            thread,
+    uint_fast8_t                priority);
+
+
+
+/**@brief       Get priority of a thread
+ * @return      Priority of the thread, without any aging boost.
+ * @iclass
+ */
+uint_fast8_t nsched_thread_get_priority_i(
+    const struct nthread *      thread);
+
+
+
+#if (CONFIG_SCHED_AGING == 1) || defined(__DOXYGEN__)
+/**@brief       Make one aging step
+ * @details     Boosts one waiting thread, see @ref CONFIG_SCHED_AGING.
+ * @iclass
+ */
+void nsched_age_i(void);
+#endif
+
+
+
+#if (CONFIG_SCHED_WEIGHTED == 1) || defined(__DOXYGEN__)
+/**@brief       Set dispatch weight of a thread
+ * @param       thread
+ *              Pointer to thread
+ * @param       weight
+ *              Number of consecutive dispatches the thread gets in one
+ *              round-robin round. Value 0 is treated as 1.
+ * @details     The new weight is used from the next round of the thread.
+ * @iclass
+ */
+void nsched_thread_set_weight_i(
+    struct nthread *            thread,
+    uint_fast8_t                weight);
+#endif
+
+
+
+#if (CONFIG_SCHED_STATS == 1) || defined(__DOXYGEN__)
+/**@brief       Take a snapshot of thread statistics
+ * @param       thread
+ *              Pointer to thread
+ * @param       stats
+ *              Pointer to structure which will receive the statistics
+ * @details     Run time of a thread is accounted when the scheduler fetches
+ *              the next thread, so the run in progress is not included.
+ * @api
+ */
+void nsched_thread_stats(
+    const struct nthread *      thread,
+    struct nthread_stats *      stats);
+
+
+
+/**@brief       Clear thread statistics
+ * @param       thread
+ *              Pointer to thread
+ * @api
+ */
+void nsched_thread_stats_clear(
+    struct nthread *            thread);
+#endif
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
 #endif
 
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if ((CONFIG_SCHED_EDF != 0) && (CONFIG_SCHED_EDF != 1))
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_EDF is out of range."
+#endif
+
+#if ((CONFIG_SCHED_SYNC != 0) && (CONFIG_SCHED_SYNC != 1))
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_SYNC is out of range."
+#endif
+
+#if ((CONFIG_SCHED_EVENT != 0) && (CONFIG_SCHED_EVENT != 1))
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_EVENT is out of range."
+#endif
+
+#if (CONFIG_SCHED_EVENT_MAILBOX_SIZE < 1u) ||                                   \
+    (CONFIG_SCHED_EVENT_MAILBOX_SIZE > 128u) ||                                 \
+    ((CONFIG_SCHED_EVENT_MAILBOX_SIZE & (CONFIG_SCHED_EVENT_MAILBOX_SIZE - 1u)) != 0u)
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_EVENT_MAILBOX_SIZE is out of range."
+#endif
+
+#if ((CONFIG_SCHED_AGING != 0) && (CONFIG_SCHED_AGING != 1))
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_AGING is out of range."
+#endif
+
+#if (CONFIG_SCHED_AGING == 1) && (CONFIG_PRIORITY_BUCKETS == 1)
+# error "Neon::Kernel::Scheduler: Priority aging requires more than one priority bucket."
+#endif
+
+#if ((CONFIG_SCHED_WEIGHTED != 0) && (CONFIG_SCHED_WEIGHTED != 1))
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_WEIGHTED is out of range."
+#endif
+
+#if ((CONFIG_SCHED_WATCHDOG != 0) && (CONFIG_SCHED_WATCHDOG != 1))
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_WATCHDOG is out of range."
+#endif
+
+#if (CONFIG_SCHED_WATCHDOG_OFFENDERS == 0u)
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_WATCHDOG_OFFENDERS is out of range."
+#endif
+
+#if ((CONFIG_SCHED_STATS != 0) && (CONFIG_SCHED_STATS != 1))
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_STATS is out of range."
+#endif
+
+#if (CONFIG_SCHED_STATS_BUCKETS < 2u) || (CONFIG_SCHED_STATS_BUCKETS > 33u)
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_STATS_BUCKETS is out of range."
+#endif
+
+#if (CONFIG_SCHED_EDF_PRIORITY > NTHREAD_PRIORITY_MAX)
+# error "Neon::Kernel::Scheduler: Configuration option CONFIG_SCHED_EDF_PRIORITY is out of range."
+#endif
 /** @endcond *//** @} *//******************************************************
  * END of sched.h
  ******************************************************************************/
@@ -0,0 +1,488 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Synchronization objects
+ * @details     Semaphores, mutexes and event flags park waiting threads on a
+ *              priority ordered wait queue and remove them from the run queue,
+ *              so a waiting thread costs nothing until the object is signaled
+ *              or the wait times out.
+ *
+ *              Threads run to completion, so a wait does not block. When the
+ *              object is not available the wait function parks the thread and
+ *              returns @ref NSYNC_PENDING; the thread should return from its
+ *              entry function. When the object is signaled it is handed off
+ *              directly to the highest priority waiter, which is made ready.
+ *              The next call of the same wait function by that thread returns
+ *              the result of the wait: @ref NSYNC_ACQUIRED or
+ *              @ref NSYNC_TIMEOUT.
+ * @code
+ *              static void consumer(void * arg)
+ *              {
+ *                  if (nsem_wait(&g_sem, nsched_get_current(), 100u) ==
+ *                      NSYNC_ACQUIRED) {
+ *                      process();
+ *                  }
+ *              }
+ * @endcode
+ * @defgroup    sched_sync Synchronization objects
+ * @brief       Synchronization objects
+ *********************************************************************//** @{ */
+
+#ifndef NEON_SCHED_SYNC_H_
+#define NEON_SCHED_SYNC_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+
+#include "port/core.h"
+#include "shared/config.h"
+#include "sched/prio_queue.h"
+#include "sched/sched.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Object was acquired
+ * @api
+ */
+#define NSYNC_ACQUIRED                  0
+
+/**@brief       Thread is parked on the object wait queue
+ * @api
+ */
+#define NSYNC_PENDING                   1
+
+/**@brief       Object was not acquired within timeout
+ * @api
+ */
+#define NSYNC_TIMEOUT                   2
+
+/**@brief       Timeout value: do not wait at all
+ * @api
+ */
+#define NSYNC_NO_WAIT                   (0u)
+
+/**@brief       Timeout value: wait without time limit
+ * @api
+ */
+#define NSYNC_WAIT_FOREVER              NCORE_TIME_TICK_MAX
+
+/**@brief       Event flags wait mode: wait until any of flags is set
+ * @api
+ */
+#define NEVENT_FLAGS_ANY                (0x0u << 0)
+
+/**@brief       Event flags wait mode: wait until all flags are set
+ * @api
+ */
+#define NEVENT_FLAGS_ALL                (0x1u << 0)
+
+/**@brief       Event flags wait mode: clear the matched flags when acquired
+ * @api
+ */
+#define NEVENT_FLAGS_CONSUME            (0x1u << 1)
+
+/**@brief       Resource protocol: priority inheritance
+ * @details     The owner inherits priority of the highest priority waiter.
+ * @api
+ */
+#define NRESOURCE_INHERIT               0u
+
+/**@brief       Resource protocol: immediate priority ceiling
+ * @details     The owner is raised to the resource ceiling as soon as it
+ *              acquires the resource.
+ * @api
+ */
+#define NRESOURCE_CEILING               1u
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Counting semaphore
+ * @api
+ */
+struct nsem
+{
+    struct nprio_queue          wait_queue;     /**<@brief Waiting threads    */
+    uint32_t                    count;          /**<@brief Available units    */
+};
+
+/**@brief       Mutex
+ * @details     Mutexes are not recursive.
+ * @api
+ */
+struct nmutex
+{
+    struct nprio_queue          wait_queue;     /**<@brief Waiting threads    */
+    struct nthread *            owner;          /**<@brief Owner thread       */
+    struct ndlist               held_node;      /**<@brief Node in owner list */
+};
+
+/**@brief       Event flags group
+ * @api
+ */
+struct nevent_flags
+{
+    struct nprio_queue          wait_queue;     /**<@brief Waiting threads    */
+    uint32_t                    flags;          /**<@brief Current flags      */
+};
+
+/**@brief       Shared resource lock
+ * @details     A mutex which bounds priority inversion. While a thread holds
+ *              the resource its priority is raised, by priority inheritance or
+ *              by priority ceiling protocol, so medium priority threads can't
+ *              delay the release. On release the priority drops to the
+ *              highest of the priority the owner had before it took its first
+ *              resource and the raises still due to the resources it holds,
+ *              so resources may be released in any order. Inheritance is
+ *              transitive: when an owner itself waits on another inheritance
+ *              resource, the owner of that resource is raised, too. When a
+ *              waiter times out or is terminated, the owners are lowered
+ *              again to what the remaining waiters require.
+ *
+ *              Since EDF class membership follows from the priority, threads
+ *              of the EDF class must not use resources and the ceiling must
+ *              not be @ref CONFIG_SCHED_EDF_PRIORITY.
+ * @api
+ */
+struct nresource
+{
+    struct nprio_queue          wait_queue;     /**<@brief Waiting threads    */
+    struct nthread *            owner;          /**<@brief Owner thread       */
+    struct ndlist               held_node;      /**<@brief Node in owner list */
+    uint_fast8_t                ceiling;        /**<@brief Priority ceiling   */
+    uint8_t                     protocol;       /**<@brief Locking protocol   */
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_SCHED_SYNC == 1) || defined(__DOXYGEN__)
+
+
+/**@brief       Initialize a semaphore
+ * @param       sem
+ *              Pointer to semaphore
+ * @param       count
+ *              Initial number of available units
+ * @api
+ */
+void nsem_init(
+    struct nsem *               sem,
+    uint32_t                    count);
+
+
+
+/**@brief       Wait for a semaphore unit
+ * @param       sem
+ *              Pointer to semaphore
+ * @param       thread
+ *              Waiting thread, usually the current thread
+ * @param       timeout
+ *              Number of ticks to wait, @ref NSYNC_NO_WAIT or
+ *              @ref NSYNC_WAIT_FOREVER
+ * @return      @ref NSYNC_ACQUIRED, @ref NSYNC_PENDING or @ref NSYNC_TIMEOUT
+ * @iclass
+ */
+int nsem_wait_i(
+    struct nsem *               sem,
+    struct nthread *            thread,
+    ncore_time_tick             timeout);
+
+
+
+/**@brief       Wait for a semaphore unit
+ * @api
+ */
+int nsem_wait(
+    struct nsem *               sem,
+    struct nthread *            thread,
+    ncore_time_tick             timeout);
+
+
+
+/**@brief       Release a semaphore unit
+ * @details     The unit is handed off to the highest priority waiter, if any.
+ * @iclass
+ */
+void nsem_post_i(
+    struct nsem *               sem);
+
+
+
+/**@brief       Release a semaphore unit
+ * @api
+ */
+void nsem_post(
+    struct nsem *               sem);
+
+
+
+/**@brief       Initialize a mutex
+ * @api
+ */
+void nmutex_init(
+    struct nmutex *             mutex);
+
+
+
+/**@brief       Lock a mutex
+ * @param       mutex
+ *              Pointer to mutex
+ * @param       thread
+ *              Locking thread, it must not already own the mutex
+ * @param       timeout
+ *              Number of ticks to wait, @ref NSYNC_NO_WAIT or
+ *              @ref NSYNC_WAIT_FOREVER
+ * @return      @ref NSYNC_ACQUIRED, @ref NSYNC_PENDING or @ref NSYNC_TIMEOUT
+ * @iclass
+ */
+int nmutex_lock_i(
+    struct nmutex *             mutex,
+    struct nthread *            thread,
+    ncore_time_tick             timeout);
+
+
+
+/**@brief       Lock a mutex
+ * @api
+ */
+int nmutex_lock(
+    struct nmutex *             mutex,
+    struct nthread *            thread,
+    ncore_time_tick             timeout);
+
+
+
+/**@brief       Unlock a mutex
+ * @param       mutex
+ *              Pointer to mutex
+ * @param       thread
+ *              Owner thread
+ * @details     The ownership is handed off to the highest priority waiter, if
+ *              any.
+ * @iclass
+ */
+void nmutex_unlock_i(
+    struct nmutex *             mutex,
+    struct nthread *            thread);
+
+
+
+/**@brief       Unlock a mutex
+ * @api
+ */
+void nmutex_unlock(
+    struct nmutex *             mutex,
+    struct nthread *            thread);
+
+
+
+/**@brief       Initialize an event flags group
+ * @api
+ */
+void nevent_flags_init(
+    struct nevent_flags *       event_flags);
+
+
+
+/**@brief       Wait for event flags
+ * @param       event_flags
+ *              Pointer to event flags group
+ * @param       thread
+ *              Waiting thread, usually the current thread
+ * @param       mask
+ *              Flags to wait for
+ * @param       mode
+ *              @ref NEVENT_FLAGS_ANY or @ref NEVENT_FLAGS_ALL, optionally
+ *              combined with @ref NEVENT_FLAGS_CONSUME
+ * @param       timeout
+ *              Number of ticks to wait, @ref NSYNC_NO_WAIT or
+ *              @ref NSYNC_WAIT_FOREVER
+ * @param       matched
+ *              When not NULL, it receives flags which satisfied the wait.
+ * @return      @ref NSYNC_ACQUIRED, @ref NSYNC_PENDING or @ref NSYNC_TIMEOUT
+ * @iclass
+ */
+int nevent_flags_wait_i(
+    struct nevent_flags *       event_flags,
+    struct nthread *            thread,
+    uint32_t                    mask,
+    uint8_t                     mode,
+    ncore_time_tick             timeout,
+    uint32_t *                  matched);
+
+
+
+/**@brief       Wait for event flags
+ * @api
+ */
+int nevent_flags_wait(
+    struct nevent_flags *       event_flags,
+    struct nthread *            thread,
+    uint32_t                    mask,
+    uint8_t                     mode,
+    ncore_time_tick             timeout,
+    uint32_t *                  matched);
+
+
+
+/**@brief       Set event flags
+ * @details     All waiters whose condition is satisfied are made ready.
+ * @iclass
+ */
+void nevent_flags_set_i(
+    struct nevent_flags *       event_flags,
+    uint32_t                    flags);
+
+
+
+/**@brief       Set event flags
+ * @api
+ */
+void nevent_flags_set(
+    struct nevent_flags *       event_flags,
+    uint32_t                    flags);
+
+
+
+/**@brief       Clear event flags
+ * @api
+ */
+void nevent_flags_clear(
+    struct nevent_flags *       event_flags,
+    uint32_t                    flags);
+
+
+
+/**@brief       Initialize a resource
+ * @param       resource
+ *              Pointer to resource
+ * @param       protocol
+ *              @ref NRESOURCE_INHERIT or @ref NRESOURCE_CEILING
+ * @param       ceiling
+ *              Highest priority of all threads which use the resource. Used
+ *              only by @ref NRESOURCE_CEILING protocol. With EDF class enabled
+ *              it must not be @ref CONFIG_SCHED_EDF_PRIORITY.
+ * @api
+ */
+void nresource_init(
+    struct nresource *          resource,
+    uint8_t                     protocol,
+    uint_fast8_t                ceiling);
+
+
+
+/**@brief       Lock a resource
+ * @param       resource
+ *              Pointer to resource
+ * @param       thread
+ *              Locking thread, it must not already own the resource
+ * @param       timeout
+ *              Number of ticks to wait, @ref NSYNC_NO_WAIT or
+ *              @ref NSYNC_WAIT_FOREVER
+ * @return      @ref NSYNC_ACQUIRED, @ref NSYNC_PENDING or @ref NSYNC_TIMEOUT
+ * @details     With @ref NRESOURCE_INHERIT protocol a thread which has to wait
+ *              raises the owner to its own priority, if that is higher. A
+ *              raise made for a waiter which later times out is kept until
+ *              the resource is released.
+ * @iclass
+ */
+int nresource_lock_i(
+    struct nresource *          resource,
+    struct nthread *            thread,
+    ncore_time_tick             timeout);
+
+
+
+/**@brief       Lock a resource
+ * @api
+ */
+int nresource_lock(
+    struct nresource *          resource,
+    struct nthread *            thread,
+    ncore_time_tick             timeout);
+
+
+
+/**@brief       Unlock a resource
+ * @param       resource
+ *              Pointer to resource
+ * @param       thread
+ *              Owner thread
+ * @details     The owner priority is lowered to what the resources it still
+ *              holds require and the resource is handed off to the highest
+ *              priority waiter, if any.
+ * @iclass
+ */
+void nresource_unlock_i(
+    struct nresource *          resource,
+    struct nthread *            thread);
+
+
+
+/**@brief       Unlock a resource
+ * @api
+ */
+void nresource_unlock(
+    struct nresource *          resource,
+    struct nthread *            thread);
+
+
+
+/**@brief       Initialize wait state of a thread
+ * @details     Called by the scheduler when a thread is initialized.
+ * @notapi
+ */
+void nsync_thread_init(
+    struct nthread *            thread);
+
+
+
+/**@brief       Clean up synchronization state of a thread being terminated
+ * @details     Called by the scheduler when a thread is terminated. A pending
+ *              wait is aborted. A semaphore unit or consumed event flags
+ *              which were handed off to the thread, but not collected yet,
+ *              are passed on. Owned mutexes and resources are unlocked and
+ *              handed off to their waiters.
+ * @notapi
+ */
+void nsync_thread_term_i(
+    struct nthread *            thread);
+
+#endif /* (CONFIG_SCHED_SYNC == 1) */
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of sync.h
+ ******************************************************************************/
+#endif /* NEON_SCHED_SYNC_H_ */
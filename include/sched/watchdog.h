@@ -0,0 +1,165 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Run budget watchdog
+ * @details     Threads must return promptly from their entry function. The
+ *              watchdog arms a virtual timer with thread run budget before
+ *              each dispatch made by nsched_run(). A thread which is still
+ *              running when the budget expires is recorded as an offender
+ *              together with the number of ticks it ran over the budget. The
+ *              application decides what to do with it in a policy callback.
+ * @defgroup    sched_watchdog Run budget watchdog
+ * @brief       Run budget watchdog
+ *********************************************************************//** @{ */
+
+#ifndef NEON_SCHED_WATCHDOG_H_
+#define NEON_SCHED_WATCHDOG_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "port/core.h"
+#include "shared/config.h"
+#include "sched/sched.h"
+
+/*===============================================================  MACRO's  ==*/
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Watchdog offender record
+ * @api
+ */
+struct nwatchdog_offender
+{
+    const struct nthread *      thread;         /**<@brief Offending thread   */
+#if (CONFIG_REGISTRY == 1) || defined(__DOXYGEN__)
+    char                        name[CONFIG_REGISTRY_NAME_SIZE];                /**<@brief Thread name at the time    */
+#endif
+    ncore_time_tick             budget;         /**<@brief Budget in ticks    */
+    ncore_time_tick             overrun;        /**<@brief Ticks over budget  */
+};
+
+/**@brief       Watchdog policy callback
+ * @details     Called by the dispatcher after the offending thread returned,
+ *              with the core lock released. It may, for example, log the
+ *              event, lower thread priority or remove the thread from the run
+ *              queue.
+ * @api
+ */
+typedef void (nwatchdog_policy)(
+    struct nthread *            thread,
+    ncore_time_tick             overrun,
+    void *                      arg);
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_SCHED_WATCHDOG == 1) || defined(__DOXYGEN__)
+
+
+/**@brief       Initialize run budget watchdog
+ * @param       policy
+ *              Policy callback, can be NULL.
+ * @param       arg
+ *              Argument for policy callback.
+ * @details     Must be called before @ref nsched_run().
+ * @api
+ */
+void nwatchdog_init(
+    nwatchdog_policy *          policy,
+    void *                      arg);
+
+
+
+/**@brief       Arm the watchdog for a thread which is about to run
+ * @return      Watchdog state:
+ *  @retval     true - the thread is watched, call @ref nwatchdog_disarm_i()
+ *              when it returns
+ *  @retval     false - the thread has zero budget and is not watched
+ * @details     Called by @ref nsched_run(). The budget timer is restarted with
+ *              @ref ntimer_restart_i(), which in the common case only pushes
+ *              its expiry later.
+ * @notapi
+ */
+bool nwatchdog_arm_i(
+    struct nthread *            thread);
+
+
+
+/**@brief       Disarm the watchdog after the thread returned
+ * @return      True when the thread has exceeded its budget and was recorded
+ *              as an offender, then call @ref nwatchdog_report() without the
+ *              lock.
+ * @details     Called by @ref nsched_run(). The budget timer is left running.
+ * @notapi
+ */
+bool nwatchdog_disarm_i(
+    struct nthread *            thread);
+
+
+
+/**@brief       Call the policy callback for the last offender
+ * @notapi
+ */
+void nwatchdog_report(
+    struct nthread *            thread);
+
+
+
+/**@brief       Get recent offenders
+ * @param       offender
+ *              Array which receives offender records, newest first.
+ * @param       size
+ *              Number of elements in array.
+ * @return      Number of records written.
+ * @api
+ */
+size_t nwatchdog_offenders(
+    struct nwatchdog_offender * offender,
+    size_t                      size);
+
+
+
+/**@brief       Get the total number of budget overruns
+ * @api
+ */
+uint32_t nwatchdog_overruns(void);
+
+#endif /* (CONFIG_SCHED_WATCHDOG == 1) */
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of watchdog.h
+ ******************************************************************************/
+#endif /* NEON_SCHED_WATCHDOG_H_ */
@@ -28,10 +28,16 @@
 
 #include <misc/timer.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "port/core.h"
 #include "shared/component.h"
 #include "shared/debug.h"
+#include "misc/trace.h"
+
+#if (CONFIG_TIMER_DEFERRED == 1)
+#include "sched/sched.h"
+#endif
 
 /*=========================================================  LOCAL MACRO's  ==*/
 
@@ -40,24 +46,86 @@
 #define NODE_TO_TIMER(node)                                                     \
     CONTAINER_OF(node, struct ntimer, list)
 
+#define DEFERRED_TO_TIMER(node)                                                 \
+    CONTAINER_OF(node, struct ntimer, deferred)
+
+/**@brief       Returns true if absolute tick @c a is before tick @c b
+ */
+#define TICK_IS_BEFORE(a, b)                                                    \
+    ((ncore_time_tick)((a) - (b)) > (NCORE_TIME_TICK_MAX / 2u))
+
 /*======================================================  LOCAL DATA TYPES  ==*/
+
+#if (CONFIG_TIMER_DEFERRED == 1)
+struct timer_deferred
+{
+    struct ndlist               queue;          /**<@brief Expired timers     */
+    struct nthread              thread;         /**<@brief Work thread        */
+    bool                        is_ready;       /**<@brief Thread is in run
+                                                 *         queue              */
+};
+#endif
+
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_TIMER_DEFERRED == 1)
+static void deferred_run(
+    void *                      arg);
+#endif
+
 /*=======================================================  LOCAL VARIABLES  ==*/
 
 static const NCOMPONENT_DEFINE("Virtual timer", "Nenad Radulovic");
 
-static struct ntimer g_timer_sentinel =
+static struct ntimer_domain     g_timer_domain =
 {
-    NDLIST_INIT(&g_timer_sentinel.list),
-    NCORE_TIME_TICK_MAX,
-    0,
-    NULL,
-    NULL,
+    {
+        NDLIST_INIT(&g_timer_domain.sentinel.list),
+        NCORE_TIME_TICK_MAX,
+        0,
+        NULL,
+        NULL,
+        &g_timer_domain,
+        0u,
+        0u,
 #if (CONFIG_API_VALIDATION == 1)
-    TIMER_SIGNATURE
+        TIMER_SIGNATURE,
+#endif
+#if (CONFIG_TIMER_DEFERRED == 1)
+        NDLIST_INIT(&g_timer_domain.sentinel.deferred),
+        0u,
+        false,
+#endif
+#if (CONFIG_TIMER_SLACK == 1)
+        0u,
+#endif
+#if (CONFIG_TIMER_STATS == 1)
+        0u,
+        0u,
+#endif
+    },
+    0u,
+#if (CONFIG_TIMER_SLACK == 1)
+    0u,
+#endif
+#if (CONFIG_TIMER_STATS == 1)
+    {0},
+    0u,
 #endif
 };
 
+#if (CONFIG_TIMER_DEFERRED == 1)
+static struct timer_deferred    g_timer_deferred;
+
+static const struct nthread_define g_timer_deferred_define =
+{
+    .name     = "timer",
+    .priority = CONFIG_TIMER_DEFERRED_PRIORITY,
+    .entry    = deferred_run,
+    .arg      = &g_timer_deferred
+};
+#endif
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
@@ -65,17 +133,38 @@ static struct ntimer g_timer_sentinel =
 static void insert_timer(
     struct ntimer *         timer)
 {
+    struct ntimer_domain *  domain = timer->domain;
     struct ntimer *         current;
+    ncore_time_tick         expiry;
 
-    current = NODE_TO_TIMER(ndlist_next(&g_timer_sentinel.list));
+    current = NODE_TO_TIMER(ndlist_next(&domain->sentinel.list));
+    expiry  = domain->now;
 
     while (current->rtick < timer->rtick) {
         timer->rtick -= current->rtick;
+        expiry       += current->rtick;
         current       = NODE_TO_TIMER(ndlist_next(&current->list));
     }
+#if (CONFIG_TIMER_STATS == 1)
+    timer->target = expiry + timer->rtick;
+
+    if (++domain->length > domain->stats.queue_max) {
+        domain->stats.queue_max = domain->length;
+    }
+#endif
+#if (CONFIG_TIMER_SLACK == 1)
+    if ((&domain->sentinel != current) &&
+        (current->rtick - timer->rtick <= timer->slack) &&
+        (current->rtick != timer->rtick)) {
+        timer->rtick = current->rtick;                                          /* Expire together with the next timer*/
+        domain->coalesced++;
+    }
+#endif
     ndlist_add_before(&current->list, &timer->list);
+    timer->expiry   = expiry + timer->rtick;
+    timer->deadline = timer->expiry;
 
-    if (&g_timer_sentinel != current) {
+    if (&domain->sentinel != current) {
         current->rtick -= timer->rtick;
     }
 }
@@ -87,12 +176,199 @@ static void remove_timer(
 {
     ndlist_remove(&timer->list);
     ndlist_init(&timer->list);
+#if (CONFIG_TIMER_STATS == 1)
+    timer->domain->length--;
+#endif
+}
+
+
+
+#if (CONFIG_TIMER_STATS == 1)
+/**@brief       Account a callback call
+ * @param       domain
+ *              Domain of the timer
+ * @param       target
+ *              Requested absolute expiry of the timer
+ * @param       begin
+ *              Time stamp taken just before the callback was called
+ */
+static void stats_callback(
+    struct ntimer_domain *  domain,
+    ncore_time_tick         target,
+    nstamp                  begin)
+{
+    struct ntimer_stats *   stats = &domain->stats;
+    ncore_time_tick         lateness;
+    nstamp                  duration;
+
+    duration = nstamp_delta(begin, nstamp_get());
+    lateness = domain->now - target;
+    stats->expired++;
+    stats->lateness_hist[
+        nstamp_log2_bucket(lateness, CONFIG_TIMER_STATS_BUCKETS)]++;
+
+    if (stats->lateness_max < lateness) {
+        stats->lateness_max = lateness;
+    }
+    stats->callback_hist[
+        nstamp_log2_bucket(duration, CONFIG_TIMER_STATS_BUCKETS)]++;
+
+    if (stats->callback_max < duration) {
+        stats->callback_max = duration;
+    }
+}
+
+
+
+static void stats_tick(
+    struct ntimer_domain *  domain,
+    uint32_t                expired)
+{
+    struct ntimer_stats *   stats = &domain->stats;
+
+    stats->ticks++;
+    stats->per_tick_hist[
+        nstamp_log2_bucket(expired, CONFIG_TIMER_STATS_BUCKETS)]++;
+
+    if (stats->per_tick_max < expired) {
+        stats->per_tick_max = expired;
+    }
+}
+#endif
+
+
+
+/**@brief       Remove a timer which is not at the queue head
+ * @details     The relative ticks of the timer are given to the next one.
+ */
+static void unlink_timer(
+    struct ntimer *         timer)
+{
+    if (&timer->domain->sentinel != NODE_TO_TIMER(ndlist_next(&timer->list))) {
+        NODE_TO_TIMER(ndlist_next(&timer->list))->rtick += timer->rtick;
+    }
+    remove_timer(timer);
+}
+
+
+
+#if (CONFIG_TIMER_DEFERRED == 1)
+/**@brief       Put an expired timer on the deferred work list
+ * @details     A timer which expires again before its callback was called is
+ *              queued only once.
+ */
+static void deferred_queue(
+    struct timer_deferred *     deferred,
+    struct ntimer *             timer)
+{
+    if (ndlist_is_empty(&timer->deferred)) {
+        ndlist_add_before(&deferred->queue, &timer->deferred);
+
+        if (!deferred->is_ready) {
+            deferred->is_ready = true;
+            nsched_thread_insert_i(&deferred->thread);
+        }
+    }
 }
 
+
+
+static void deferred_run(
+    void *                      arg)
+{
+    struct timer_deferred *     deferred = arg;
+    ncore_lock                  sys_lock;
+    uint_fast8_t                count;
+
+    ncore_lock_enter(&sys_lock);
+
+    for (count = 0u;
+         (count < CONFIG_TIMER_DEFERRED_BATCH) &&
+            !ndlist_is_empty(&deferred->queue);
+         count++) {
+        struct ntimer *         timer;
+        void                 (* fn)(void *);
+        void *                  fn_arg;
+#if (CONFIG_TIMER_STATS == 1)
+        struct ntimer_domain *  domain;
+        ncore_time_tick         target;
+        nstamp                  begin;
+#endif
+
+        timer  = DEFERRED_TO_TIMER(ndlist_next(&deferred->queue));
+        fn     = timer->fn;
+        fn_arg = timer->arg;
+#if (CONFIG_TIMER_STATS == 1)
+        domain = timer->domain;
+        target = timer->fired;
+#endif
+        ndlist_remove(&timer->deferred);
+        ndlist_init(&timer->deferred);
+        timer->is_in_flight = true;                                             /* Reported by cancel while unlocked  */
+        ncore_lock_exit(&sys_lock);
+#if (CONFIG_TIMER_STATS == 1)
+        begin  = nstamp_get();
+#endif
+        fn(fn_arg);                                                             /* Callback runs without the lock     */
+        ncore_lock_enter(&sys_lock);
+        timer->is_in_flight = false;
+#if (CONFIG_TIMER_STATS == 1)
+        stats_callback(domain, target, begin);
+#endif
+    }
+
+    if (ndlist_is_empty(&deferred->queue)) {
+        deferred->is_ready = false;
+        nsched_thread_remove_i(&deferred->thread);
+    }
+    ncore_lock_exit(&sys_lock);
+}
+#endif
+
 /*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
 /*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
 
 
+void ntimer_domain_init(
+    struct ntimer_domain *      domain)
+{
+    struct ntimer *             sentinel;
+
+    NREQUIRE(NAPI_POINTER, domain != NULL);
+
+    sentinel = &domain->sentinel;
+    ndlist_init(&sentinel->list);
+    sentinel->rtick  = NCORE_TIME_TICK_MAX;
+    sentinel->itick  = 0u;
+    sentinel->fn     = NULL;
+    sentinel->arg    = NULL;
+    sentinel->domain = domain;
+    domain->now      = 0u;
+#if (CONFIG_TIMER_STATS == 1)
+    memset(&domain->stats, 0, sizeof(domain->stats));
+    domain->length   = 0u;
+#endif
+    NOBLIGATION(sentinel->signature = TIMER_SIGNATURE);
+#if (CONFIG_TIMER_DEFERRED == 1)
+    ndlist_init(&sentinel->deferred);
+    sentinel->flags        = 0u;
+    sentinel->is_in_flight = false;
+#endif
+#if (CONFIG_TIMER_SLACK == 1)
+    sentinel->slack   = 0u;
+    domain->coalesced = 0u;
+#endif
+}
+
+
+
+struct ntimer_domain * ntimer_domain_default(void)
+{
+    return (&g_timer_domain);
+}
+
+
+
 void ntimer_init(
     struct ntimer *             timer)
 {
@@ -100,11 +376,21 @@ void ntimer_init(
     NREQUIRE(NAPI_OBJECT,  timer->signature != TIMER_SIGNATURE);
 
     ndlist_init(&timer->list);
+    timer->fn     = NULL;
+    timer->domain = &g_timer_domain;
+#if (CONFIG_TIMER_DEFERRED == 1)
+    ndlist_init(&timer->deferred);
+    timer->flags        = 0u;
+    timer->is_in_flight = false;
+#endif
+#if (CONFIG_TIMER_SLACK == 1)
+    timer->slack = 0u;
+#endif
 }
 
 
 
-void ntimer_cancel_i(
+bool ntimer_cancel_i(
     struct ntimer *             timer)
 {
     NREQUIRE(NAPI_POINTER, timer != NULL);
@@ -112,55 +398,146 @@ void ntimer_cancel_i(
     if (!ndlist_is_empty(&timer->list)) {
         NREQUIRE(NAPI_OBJECT,  timer->signature == TIMER_SIGNATURE);
 
-        if (&g_timer_sentinel != NODE_TO_TIMER(ndlist_next(&timer->list))) {
-            NODE_TO_TIMER(ndlist_next(&timer->list))->rtick += timer->rtick;
-        }
-        remove_timer(timer);
+        unlink_timer(timer);
     }
+#if (CONFIG_TIMER_DEFERRED == 1)
+    if (!ndlist_is_empty(&timer->deferred)) {                                   /* Expired, but callback not called   */
+        ndlist_remove(&timer->deferred);
+        ndlist_init(&timer->deferred);
+    }
+#endif
     NOBLIGATION(timer->signature = ~TIMER_SIGNATURE);
+
+#if (CONFIG_TIMER_DEFERRED == 1)
+    return (timer->is_in_flight);
+#else
+    return (false);
+#endif
+}
+
+
+
+void ntimer_restart_i(
+    struct ntimer *             timer,
+    ncore_time_tick             tick)
+{
+    NREQUIRE(NAPI_POINTER, timer != NULL);
+    NREQUIRE(NAPI_USAGE,   timer->fn != NULL);
+    NREQUIRE(NAPI_RANGE,   tick > 0);
+
+    if (timer->itick != 0u) {
+        timer->itick = tick;
+    }
+
+    if (ntimer_is_running_i(timer)) {
+        ncore_time_tick         deadline;
+
+        deadline = timer->domain->now + tick;
+
+        if (!TICK_IS_BEFORE(deadline, timer->expiry)) {
+            timer->deadline = deadline;                                         /* Later: move it when it expires     */
+
+            return;
+        }
+        unlink_timer(timer);
+    }
+    timer->rtick = tick;
+    insert_timer(timer);
+    NOBLIGATION(timer->signature = TIMER_SIGNATURE);
 }
 
 
 
-void ntimer_cancel(
+void ntimer_restart(
+    struct ntimer *             timer,
+    ncore_time_tick             tick)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    ntimer_restart_i(timer, tick);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+bool ntimer_cancel(
     struct ntimer *             timer)
 {
     ncore_lock                   sys_lock;
+    bool                        is_in_flight;
 
     ncore_lock_enter(&sys_lock);
-    ntimer_cancel_i(timer);
+    is_in_flight = ntimer_cancel_i(timer);
     ncore_lock_exit(&sys_lock);
+
+    return (is_in_flight);
 }
 
 
 
-void ntimer_start_i(
+void ntimer_domain_start_i(
+    struct ntimer_domain *      domain,
     struct ntimer *             timer,
-    ncore_time_tick              tick,
+    ncore_time_tick             tick,
     void                     (* fn)(void *),
     void *                      arg,
     uint8_t                     flags)
 {
+    NREQUIRE(NAPI_POINTER, domain != NULL);
     NREQUIRE(NAPI_POINTER, timer != NULL);
     NREQUIRE(NAPI_USAGE,   timer->signature != TIMER_SIGNATURE);
     NREQUIRE(NAPI_RANGE,   tick > 0);
     NREQUIRE(NAPI_POINTER, fn != NULL);
 
-    timer->fn    = fn;
-    timer->arg   = arg;
-    timer->rtick = tick;
+    timer->fn     = fn;
+    timer->arg    = arg;
+    timer->rtick  = tick;
+    timer->domain = domain;
 
     if (flags & NTIMER_ATTR_REPEAT) {
         timer->itick = tick;
     } else {
         timer->itick = 0u;
     }
+#if (CONFIG_TIMER_DEFERRED == 1)
+    timer->flags = flags;
+#endif
     insert_timer(timer);
     NOBLIGATION(timer->signature = TIMER_SIGNATURE);
 }
 
 
 
+void ntimer_domain_start(
+    struct ntimer_domain *      domain,
+    struct ntimer *             timer,
+    ncore_time_tick             tick,
+    void                     (* fn)(void *),
+    void *                      arg,
+    uint8_t                     flags)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    ntimer_domain_start_i(domain, timer, tick, fn, arg, flags);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void ntimer_start_i(
+    struct ntimer *             timer,
+    ncore_time_tick             tick,
+    void                     (* fn)(void *),
+    void *                      arg,
+    uint8_t                     flags)
+{
+    ntimer_domain_start_i(&g_timer_domain, timer, tick, fn, arg, flags);
+}
+
+
+
 void ntimer_start(
     struct ntimer *             timer,
     ncore_time_tick              tick,
@@ -204,11 +581,7 @@ ncore_time_tick ntimer_remaining(
     ncore_lock_enter(&sys_lock);
 
     if (ntimer_is_running_i(timer)) {
-
-        do {
-            remaining += timer->rtick;
-            timer      = NODE_TO_TIMER(ndlist_prev(&timer->list));
-        } while (timer != &g_timer_sentinel);
+        remaining = timer->deadline - timer->domain->now;
     }
     ncore_lock_exit(&sys_lock);
 
@@ -217,12 +590,110 @@ ncore_time_tick ntimer_remaining(
 
 
 
-void ncore_timer_isr(void)
+ncore_time_tick ntimer_next_expiry_i(void)
+{
+    return (ntimer_domain_next_expiry_i(&g_timer_domain));
+}
+
+
+
+ncore_time_tick ntimer_domain_next_expiry_i(
+    const struct ntimer_domain * domain)
+{
+    return (NODE_TO_TIMER(ndlist_next(&domain->sentinel.list))->rtick);         /* Sentinel holds NCORE_TIME_TICK_MAX */
+}
+
+
+
+#if (CONFIG_TIMER_SLACK == 1)
+void ntimer_set_slack(
+    struct ntimer *             timer,
+    ncore_time_tick             slack)
+{
+    NREQUIRE(NAPI_POINTER, timer != NULL);
+
+    timer->slack = slack;
+}
+
+
+
+uint32_t ntimer_coalesced(void)
+{
+    return (ntimer_domain_coalesced(&g_timer_domain));
+}
+
+
+
+uint32_t ntimer_domain_coalesced(
+    const struct ntimer_domain * domain)
+{
+    NREQUIRE(NAPI_POINTER, domain != NULL);
+
+    return (domain->coalesced);
+}
+#endif
+
+
+
+#if (CONFIG_TIMER_STATS == 1)
+void ntimer_domain_stats(
+    const struct ntimer_domain * domain,
+    struct ntimer_stats *       stats)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, domain != NULL);
+    NREQUIRE(NAPI_POINTER, stats  != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    *stats = domain->stats;
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void ntimer_domain_stats_clear(
+    struct ntimer_domain *      domain)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, domain != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    memset(&domain->stats, 0, sizeof(domain->stats));
+    domain->stats.queue_max = domain->length;
+    ncore_lock_exit(&sys_lock);
+}
+#endif
+
+
+
+#if (CONFIG_TIMER_DEFERRED == 1)
+void ntimer_deferred_init(void)
 {
-    if (!ndlist_is_empty(&g_timer_sentinel.list)) {
+    struct timer_deferred *     deferred = &g_timer_deferred;
+
+    ndlist_init(&deferred->queue);
+    deferred->is_ready = false;
+    nsched_thread_init(&deferred->thread, &g_timer_deferred_define);
+}
+#endif
+
+
+
+void ntimer_domain_isr(
+    struct ntimer_domain *      domain)
+{
+#if (CONFIG_TIMER_STATS == 1)
+    uint32_t                    expired = 0u;
+#endif
+
+    domain->now++;
+
+    if (!ndlist_is_empty(&domain->sentinel.list)) {
         struct ntimer *         current;
 
-        current = NODE_TO_TIMER(ndlist_next(&g_timer_sentinel.list));
+        current = NODE_TO_TIMER(ndlist_next(&domain->sentinel.list));
         NREQUIRE(NAPI_USAGE, TIMER_SIGNATURE == current->signature);
         --current->rtick;
 
@@ -231,7 +702,19 @@ void ncore_timer_isr(void)
 
             NREQUIRE(NAPI_USAGE, TIMER_SIGNATURE == current->signature);
             remove_timer(current);
+
+            if (current->deadline != domain->now) {                             /* Restarted later, requeue it now    */
+                current->rtick = current->deadline - domain->now;
+                insert_timer(current);
+                current = NODE_TO_TIMER(ndlist_next(&domain->sentinel.list));
+
+                continue;
+            }
             NOBLIGATION(current->signature = ~TIMER_SIGNATURE);
+#if (CONFIG_TIMER_STATS == 1)
+            current->fired = current->target;                                   /* Repeat insert overwrites target    */
+            expired++;
+#endif
 
             if (current->itick != 0u) {
                 current->rtick = current->itick;
@@ -239,10 +722,36 @@ void ncore_timer_isr(void)
                 NOBLIGATION(current->signature = TIMER_SIGNATURE);
             }
             tmp     = current;
-            current = NODE_TO_TIMER(ndlist_next(&g_timer_sentinel.list));
-            tmp->fn(tmp->arg);
+            current = NODE_TO_TIMER(ndlist_next(&domain->sentinel.list));
+            NTRACE(NTRACE_TIMER_FIRE, tmp, 0u);
+#if (CONFIG_TIMER_DEFERRED == 1)
+            if ((tmp->flags & NTIMER_ATTR_DEFERRED) != 0u) {
+                deferred_queue(&g_timer_deferred, tmp);
+            } else
+#endif
+            {
+#if (CONFIG_TIMER_STATS == 1)
+                nstamp          begin;
+
+                begin = nstamp_get();
+                tmp->fn(tmp->arg);
+                stats_callback(domain, tmp->fired, begin);
+#else
+                tmp->fn(tmp->arg);
+#endif
+            }
         }
     }
+#if (CONFIG_TIMER_STATS == 1)
+    stats_tick(domain, expired);
+#endif
+}
+
+
+
+void ncore_timer_isr(void)
+{
+    ntimer_domain_isr(&g_timer_domain);
 }
 
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
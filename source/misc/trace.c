@@ -0,0 +1,120 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Binary event trace implementation
+ * @addtogroup  base_trace
+ *********************************************************************//** @{ */
+/**@defgroup    base_trace_impl Implementation
+ * @brief       Binary event trace implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "misc/trace.h"
+
+#if !defined(__GNUC__)
+#include <stdatomic.h>
+#endif
+
+#if (CONFIG_TRACE == 1)
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define RING_MASK                       (CONFIG_TRACE_EVENTS - 1u)
+
+/**@brief       Acquire fence between reading an event and checking @c head
+ */
+#if defined(__GNUC__)
+#define READ_BARRIER()                  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#else
+#define READ_BARRIER()                  atomic_thread_fence(memory_order_acquire)
+#endif
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Event Trace", "Nenad Radulovic");
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+
+struct ntrace_ring              g_trace_ring;
+
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+size_t ntrace_dump(
+    void                     (* write)(void *, const void *, size_t),
+    void *                      arg)
+{
+    struct ntrace_header        header;
+    uint32_t                    head;
+    uint32_t                    index;
+
+    NREQUIRE(NAPI_POINTER, write != NULL);
+
+    head  = g_trace_ring.head;
+    index = head - ((head < RING_MASK) ? head : RING_MASK);
+
+    header.magic      = NTRACE_MAGIC;
+    header.version    = NTRACE_VERSION;
+    header.event_size = (uint16_t)sizeof(struct ntrace_event);
+    header.count      = head - index;
+    header.stamp_freq = (uint32_t)CONFIG_TRACE_STAMP_FREQ;
+    write(arg, &header, sizeof(header));
+
+    for (; index != head; index++) {
+        struct ntrace_event     event;
+
+        event = g_trace_ring.event[index & RING_MASK];
+        READ_BARRIER();
+
+        if ((uint32_t)(g_trace_ring.head - index) >= CONFIG_TRACE_EVENTS) {     /* Overwritten while we were reading, */
+            event.type = 0u;                                                    /* keep the count but mark it unused. */
+        }
+        write(arg, &event, sizeof(event));
+    }
+
+    return (header.count);
+}
+
+
+
+void ntrace_clear(void)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    g_trace_ring.head = 0u;
+    ncore_lock_exit(&sys_lock);
+}
+
+#endif /* (CONFIG_TRACE == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of trace.c
+ ******************************************************************************/
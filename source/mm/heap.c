@@ -30,11 +30,14 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <string.h>
+
 #include "port/core.h"
 #include "shared/component.h"
 #include "shared/debug.h"
 #include "shared/bitop.h"
 #include "mm/heap.h"
+#include "mm/profile.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
 
@@ -42,27 +45,227 @@
  */
 #define HEAP_MEM_SIGNATURE              ((unsigned int)0xdeadbee1u)
 
+/**@brief       Guard canary value written right after the requested size
+ */
+#define HEAP_CANARY                     ((uint32_t)0xa5c3e10fu)
+
+/**@brief       Space taken by the canary and the requested size trailer
+ * @details     The requested size is kept in the last word of an allocated
+ *              block, so the canary can be found right after the user data.
+ */
+#if (CONFIG_HEAP_CANARY == 1)
+#define HEAP_CANARY_SIZE                (sizeof(uint32_t) + sizeof(size_t))
+#else
+#define HEAP_CANARY_SIZE                0u
+#endif
+
+#if (CONFIG_HEAP_OFFSET_LINKS == 1)
+/**@brief       Signature of persistent heap image
+ */
+#define HEAP_IMAGE_MAGIC                ((uint32_t)0x4e48504du)
+
+/**@brief       Size of persistent heap image header
+ */
+#define HEAP_IMAGE_SIZE                                                         \
+    NALIGN_UP(sizeof(struct heap_image), NCPU_DATA_ALIGNMENT)
+
+/**@brief       Convert a block link into block pointer
+ * @details     Links are stored as offsets from the heap sentinel, so the heap
+ *              storage may be mapped at a different address each time.
+ */
+#define BLOCK(mem_class, link)                                                  \
+    ((struct heap_block *)((uint8_t *)(mem_class)->base + (link)))
+
+/**@brief       Convert a block pointer into block link
+ */
+#define LINK(mem_class, block)                                                  \
+    ((heap_link)((const uint8_t *)(block) - (const uint8_t *)(mem_class)->base))
+#else
+#define HEAP_IMAGE_SIZE                 0u
+#define BLOCK(mem_class, link)          (link)
+#define LINK(mem_class, block)          ((struct heap_block *)(block))
+#endif
+
+/**@brief       Get the absolute size of a free or allocated block
+ */
+#define BLOCK_SIZE(block)                                                       \
+    ((size_t)((block)->phy.size < 0 ? -(block)->phy.size : (block)->phy.size))
+
+#if (CONFIG_HEAP_FRONTEND == 1)
+/**@brief       Size of small object header
+ * @details     The header holds only the size class tag of an object. The tag
+ *              occupies the same place as @c phy.size of a regular block, so
+ *              the free path can tell them apart by sign: allocated regular
+ *              blocks have negative size while size class tags are never
+ *              negative. Tags are counted down from @c NCPU_SSIZE_MAX, far
+ *              above any real block size, so a free regular block is not
+ *              taken for a small object either.
+ */
+#define HEAP_FE_HEADER_SIZE                                                     \
+    NALIGN_UP(offsetof(struct heap_block, free) -                               \
+        offsetof(struct heap_block, phy.size), NCPU_DATA_ALIGNMENT)
+
+/**@brief       Size of one small object slot including the header
+ */
+#define HEAP_FE_SLOT_SIZE(class_no)                                             \
+    (HEAP_FE_HEADER_SIZE + ((size_t)(class_no) + 1u) * CONFIG_HEAP_FE_GRANULE)
+
+/**@brief       Tag of an allocated small object of a size class
+ */
+#define HEAP_FE_TAG(class_no)                                                   \
+    (NCPU_SSIZE_MAX - (ncpu_ssize)(class_no))
+
+/**@brief       Tag of a small object which is on a class free list
+ * @details     It is below all valid class tags, so a second free of the same
+ *              object is detected.
+ */
+#define HEAP_FE_TAG_FREE                HEAP_FE_TAG(CONFIG_HEAP_FE_CLASSES)
+
+/**@brief       Get the size class tag of a small object
+ */
+#define MEM_TO_TAG(mem)                                                         \
+    (&((struct heap_block *)                                                    \
+        ((uint8_t *)(mem) - offsetof(struct heap_block, free)))->phy.size)
+#endif
+
 /*======================================================  LOCAL DATA TYPES  ==*/
 
+/**@brief       Link to other block
+ */
+#if (CONFIG_HEAP_OFFSET_LINKS == 1)
+typedef ncpu_ssize heap_link;
+#else
+typedef struct heap_block * heap_link;
+#endif
+
 /**@brief       Dynamic allocator memory block header structure
  */
 struct PORT_C_ALIGN(NCPU_DATA_ALIGNMENT) heap_block
 {
     struct heap_phy
     {
-        struct heap_block *         prev;
+        heap_link                   prev;
         ncpu_ssize                  size;
     }                           phy;
     struct heap_free
     {
-        struct heap_block *         next;
-        struct heap_block *         prev;
+        heap_link                   next;
+        heap_link                   prev;
     }                           free;
 };
 
+#if (CONFIG_HEAP_OFFSET_LINKS == 1)
+/**@brief       Persistent heap image header
+ * @details     The header is placed at the beginning of heap storage and is
+ *              used to recognize the heap when the storage is attached again.
+ */
+struct heap_image
+{
+    uint32_t                    magic;
+    uint32_t                    block_size;     /**<@brief Header ABI check   */
+    size_t                      size;           /**<@brief Storage size       */
+    heap_link                   root;           /**<@brief Application root   */
+};
+#endif
+
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
 
 
+static struct heap_block * block_begin(
+    const struct nmem *         mem_class);
+
+
+
+static struct heap_block * block_next(
+    const struct heap_block *   block);
+
+
+
+static bool block_is_in_range(
+    const struct nmem *         mem_class,
+    const struct heap_block *   block);
+
+
+
+static bool block_is_valid(
+    const struct nmem *         mem_class,
+    const struct heap_block *   block);
+
+
+
+#if (CONFIG_HEAP_CANARY == 1)
+static size_t * block_trailer(
+    const struct heap_block *   block);
+
+
+
+static void block_canary_set(
+    struct heap_block *         block,
+    size_t                      size);
+
+
+
+static bool block_canary_is_valid(
+    const struct heap_block *   block);
+#endif
+
+
+
+#if (CONFIG_HEAP_CHECK == 1)
+static void block_absorb(
+    struct nmem *               mem_class,
+    const struct heap_block *   absorbed,
+    struct heap_block *         into);
+#endif
+
+
+
+static void * block_alloc_i(
+    struct nmem *               mem_class,
+    size_t                      size);
+
+
+
+static void block_free_i(
+    struct nmem *               mem_class,
+    void *                      mem);
+
+
+
+static void heap_setup(
+    struct nheap *              heap,
+    void *                      storage,
+    size_t                      size);
+
+
+
+static bool heap_walk_i(
+    struct nmem *               mem_class,
+    void                     (* fn)(void *, void *, size_t, bool),
+    void *                      arg);
+
+
+
+#if (CONFIG_HEAP_FRONTEND == 1)
+static void * fe_refill_i(
+    struct nheap *              heap,
+    uint_fast8_t                class_no);
+
+
+
+static void * fe_alloc_i(
+    struct nheap *              heap,
+    size_t                      size);
+
+
+
+static void fe_free_i(
+    struct nheap *              heap,
+    void *                      mem);
+#endif
+
+
+
 static void * heap_alloc_i(
     struct nmem *               mem_class,
     size_t                      size);
@@ -81,21 +284,178 @@ static const NCOMPONENT_DEFINE("Heap Memory Management", "Nenad Radulovic");
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
 
-static void * heap_alloc_i(
+static struct heap_block * block_begin(
+    const struct nmem *         mem_class)
+{
+    return ((struct heap_block *)((uint8_t *)mem_class->base - mem_class->size -
+        sizeof(struct heap_phy [1])));
+}
+
+
+
+static struct heap_block * block_next(
+    const struct heap_block *   block)
+{
+    return ((struct heap_block *)((uint8_t *)block + BLOCK_SIZE(block) +
+        sizeof(struct heap_phy [1])));
+}
+
+
+
+static bool block_is_in_range(
+    const struct nmem *         mem_class,
+    const struct heap_block *   block)
+{
+    if (((uintptr_t)block < (uintptr_t)block_begin(mem_class)) ||
+        ((uintptr_t)block > (uintptr_t)mem_class->base)) {
+
+        return (false);
+    }
+
+    return (true);
+}
+
+
+
+static bool block_is_valid(
+    const struct nmem *         mem_class,
+    const struct heap_block *   block)
+{
+    const struct heap_block *   sentinel = mem_class->base;
+    const struct heap_block *   next;
+
+    if (!block_is_in_range(mem_class, block) || (block == sentinel)) {
+
+        return (false);
+    }
+
+    if ((block->phy.size == 0) || (BLOCK_SIZE(block) > mem_class->size)) {
+
+        return (false);
+    }
+    next = block_next(block);
+
+    if (!block_is_in_range(mem_class, next) ||                                  /* Next block must point back to us.  */
+        (BLOCK(mem_class, next->phy.prev) != block)) {
+
+        return (false);
+    }
+
+    if (block == block_begin(mem_class)) {                                      /* The first block points to sentinel.*/
+
+        if (BLOCK(mem_class, block->phy.prev) != sentinel) {
+
+            return (false);
+        }
+    } else if (!block_is_in_range(mem_class, BLOCK(mem_class, block->phy.prev)) ||
+               (BLOCK(mem_class, block->phy.prev) >= block) ||
+               (block_next(BLOCK(mem_class, block->phy.prev)) != block)) {
+
+        return (false);
+    }
+
+    if (block->phy.size > 0) {                                                  /* Free block                         */
+
+        if ((next != sentinel) && (next->phy.size > 0)) {                       /* Free blocks are always merged.     */
+
+            return (false);
+        }
+
+        if (!block_is_in_range(mem_class, BLOCK(mem_class, block->free.next)) ||
+            !block_is_in_range(mem_class, BLOCK(mem_class, block->free.prev)) ||
+            (BLOCK(mem_class, block->free.next)->free.prev !=
+                LINK(mem_class, block)) ||
+            (BLOCK(mem_class, block->free.prev)->free.next !=
+                LINK(mem_class, block))) {
+
+            return (false);
+        }
+    }
+#if (CONFIG_HEAP_CANARY == 1)
+    else if (!block_canary_is_valid(block)) {                                   /* Allocated block overflow           */
+
+        return (false);
+    }
+#endif
+
+    return (true);
+}
+
+
+
+#if (CONFIG_HEAP_CANARY == 1)
+static size_t * block_trailer(
+    const struct heap_block *   block)
+{
+    return ((size_t *)((uint8_t *)&block->free + BLOCK_SIZE(block) -
+        sizeof(size_t)));
+}
+
+
+
+static void block_canary_set(
+    struct heap_block *         block,
+    size_t                      size)
+{
+    uint32_t                    canary = HEAP_CANARY;
+
+    *block_trailer(block) = size;
+    memcpy((uint8_t *)&block->free + size, &canary, sizeof(canary));           /* May be unaligned                   */
+}
+
+
+
+static bool block_canary_is_valid(
+    const struct heap_block *   block)
+{
+    uint32_t                    canary;
+    size_t                      size;
+
+    size = *block_trailer(block);
+
+    if (size > BLOCK_SIZE(block) - HEAP_CANARY_SIZE) {                          /* Trailer itself was overwritten     */
+
+        return (false);
+    }
+    memcpy(&canary, (const uint8_t *)&block->free + size, sizeof(canary));
+
+    return (canary == HEAP_CANARY);
+}
+#endif
+
+
+
+#if (CONFIG_HEAP_CHECK == 1)
+static void block_absorb(
+    struct nmem *               mem_class,
+    const struct heap_block *   absorbed,
+    struct heap_block *         into)
+{
+    struct nheap *              heap;
+
+    heap = CONTAINER_OF(mem_class, struct nheap, mem_class);
+
+    if (heap->check_cursor == absorbed) {                                       /* Keep the checker cursor on a valid */
+        heap->check_cursor = into;                                              /* block.                             */
+    }
+}
+#endif
+
+
+
+static void * block_alloc_i(
     struct nmem *               mem_class,
     size_t                      size)
 {
     struct heap_block *         sentinel;
     struct heap_block *         curr;
+#if (CONFIG_HEAP_CANARY == 1)
+    size_t                      requested = size;
+#endif
 
-    NREQUIRE(NAPI_POINTER, mem_class != NULL);
-    NREQUIRE(NAPI_OBJECT,  mem_class->signature == HEAP_MEM_SIGNATURE);
-    NREQUIRE(NAPI_RANGE,   (size != 0u) && (size < NCPU_SSIZE_MAX));
-
-
-    size     = NALIGN_UP(size, sizeof(struct heap_phy [1]));
+    size     = NALIGN_UP(size + HEAP_CANARY_SIZE, sizeof(struct heap_phy [1]));
     sentinel = mem_class->base;
-    curr     = sentinel->free.next;
+    curr     = BLOCK(mem_class, sentinel->free.next);
 
     while (curr != sentinel) {
 
@@ -111,7 +471,7 @@ static void * heap_alloc_i(
                                        /* Point back to the current block     */
                 tmp            = (struct heap_block *)
                     ((uint8_t *)curr + size + sizeof(struct heap_phy [1]));
-                tmp->phy.prev  = curr;
+                tmp->phy.prev  = LINK(mem_class, curr);
                 tmp->phy.size  = curr->phy.size;
                 tmp->phy.size -= (ncpu_ssize)size;
                 tmp->phy.size -= (ncpu_ssize)sizeof(struct heap_phy [1]);
@@ -121,12 +481,16 @@ static void * heap_alloc_i(
                                        /* block back to free list             */
                 tmp->free.next = curr->free.next;
                 tmp->free.prev = curr->free.prev;
-                tmp->free.next->free.prev = tmp;
-                tmp->free.prev->free.next = tmp;
+                BLOCK(mem_class, tmp->free.next)->free.prev = LINK(mem_class, tmp);
+                BLOCK(mem_class, tmp->free.prev)->free.next = LINK(mem_class, tmp);
+#if (CONFIG_HEAP_CANARY == 1)
+                                       /* Canary may overlap the free links   */
+                block_canary_set(curr, requested);
+#endif
                 curr           = (struct heap_block *)
                     ((uint8_t *)tmp + tmp->phy.size + sizeof(struct heap_phy [1]));
                                        /* Point to the newly created block    */
-                curr->phy.prev = tmp;
+                curr->phy.prev = LINK(mem_class, tmp);
 
                 return (mem);
             } else {
@@ -135,68 +499,325 @@ static void * heap_alloc_i(
                                       /* Remove current block from free list  */
                                       /* and mark it block as allocated       */
                 mem                        = (void *)(&curr->free);
-                curr->free.next->free.prev = curr->free.prev;
-                curr->free.prev->free.next = curr->free.next;
+                BLOCK(mem_class, curr->free.next)->free.prev = curr->free.prev;
+                BLOCK(mem_class, curr->free.prev)->free.next = curr->free.next;
                 curr->phy.size             = curr->phy.size * (-1);
+#if (CONFIG_HEAP_CANARY == 1)
+                block_canary_set(curr, requested);
+#endif
 
                 return (mem);
             }
         }
-        curr = curr->free.next;
+        curr = BLOCK(mem_class, curr->free.next);
     }
 
     return (NULL);
 }
 
 
-static void heap_free_i(
+static void block_free_i(
     struct nmem *               mem_class,
     void *                      mem)
 {
     struct heap_block *         curr;
+    struct heap_block *         prev;
     struct heap_block *         tmp;
 
-    NREQUIRE(NAPI_POINTER, mem_class != NULL);
-    NREQUIRE(NAPI_OBJECT,  mem_class->signature == HEAP_MEM_SIGNATURE);
-    NREQUIRE(NAPI_POINTER, mem != NULL);
-
     curr           = (struct heap_block *)
         ((uint8_t *)mem - offsetof(struct heap_block, free));
+
+#if (CONFIG_HEAP_CHECK == 1) || (CONFIG_HEAP_CANARY == 1)
+# if (CONFIG_HEAP_CHECK == 1)
+    if ((curr->phy.size >= 0) || !block_is_valid(mem_class, curr)) {
+# else
+    if (!block_canary_is_valid(curr)) {
+# endif
+        struct nheap *          heap;
+
+        heap = CONTAINER_OF(mem_class, struct nheap, mem_class);
+        heap->corrupted++;                                                      /* Rather leak the block than corrupt */
+        NASSERT_ALWAYS("corrupted heap block");                                 /* its neighbours.                    */
+
+        return;
+    }
+#endif
     curr->phy.size = (ncpu_ssize)curr->phy.size * (-1);                         /* Mark block as free                   */
+    prev           = BLOCK(mem_class, curr->phy.prev);
     tmp            = (struct heap_block *)
         ((uint8_t *)curr + curr->phy.size + sizeof(struct heap_phy [1]));
 
-    if ((curr->phy.prev->phy.size > 0) && (tmp->phy.size < 0)) {                /* Previous block is free               */
-        curr->phy.prev->phy.size  += curr->phy.size;
-        curr->phy.prev->phy.size  += (ncpu_ssize)sizeof(struct heap_phy [1]);
+    if ((prev->phy.size > 0) && (tmp->phy.size < 0)) {                          /* Previous block is free               */
+#if (CONFIG_HEAP_CHECK == 1)
+        block_absorb(mem_class, curr, prev);
+#endif
+        prev->phy.size            += curr->phy.size;
+        prev->phy.size            += (ncpu_ssize)sizeof(struct heap_phy [1]);
         tmp->phy.prev              = curr->phy.prev;
-    } else if ((curr->phy.prev->phy.size < 0) && (tmp->phy.size > 0)) {         /* Next block is free                   */
+    } else if ((prev->phy.size < 0) && (tmp->phy.size > 0)) {                   /* Next block is free                   */
+#if (CONFIG_HEAP_CHECK == 1)
+        block_absorb(mem_class, tmp, curr);
+#endif
         curr->free.next            = tmp->free.next;
         curr->free.prev            = tmp->free.prev;
-        curr->free.prev->free.next = curr;
-        curr->free.next->free.prev = curr;
+        BLOCK(mem_class, curr->free.prev)->free.next = LINK(mem_class, curr);
+        BLOCK(mem_class, curr->free.next)->free.prev = LINK(mem_class, curr);
         curr->phy.size            += tmp->phy.size;
         curr->phy.size            += (ncpu_ssize)sizeof(struct heap_phy [1]);
         tmp                        = (struct heap_block *)
             ((uint8_t *)curr + curr->phy.size + sizeof(struct heap_phy [1]));
-        tmp->phy.prev              = curr;
-    } else if ((curr->phy.prev->phy.size > 0) && (tmp->phy.size > 0)) {         /* Previous and next blocks are free    */
-        tmp->free.prev->free.next  = tmp->free.next;
-        tmp->free.next->free.prev  = tmp->free.prev;
-        curr->phy.prev->phy.size  += curr->phy.size + tmp->phy.size;
-        curr->phy.prev->phy.size  += (ncpu_ssize)sizeof(struct heap_phy [2]);
+        tmp->phy.prev              = LINK(mem_class, curr);
+    } else if ((prev->phy.size > 0) && (tmp->phy.size > 0)) {                   /* Previous and next blocks are free    */
+#if (CONFIG_HEAP_CHECK == 1)
+        block_absorb(mem_class, curr, prev);
+        block_absorb(mem_class, tmp,  prev);
+#endif
+        BLOCK(mem_class, tmp->free.prev)->free.next = tmp->free.next;
+        BLOCK(mem_class, tmp->free.next)->free.prev = tmp->free.prev;
+        prev->phy.size            += curr->phy.size + tmp->phy.size;
+        prev->phy.size            += (ncpu_ssize)sizeof(struct heap_phy [2]);
         tmp                        = (struct heap_block *)
-            ((uint8_t *)curr->phy.prev + curr->phy.prev->phy.size +
-            sizeof(struct heap_phy [1]));
+            ((uint8_t *)prev + prev->phy.size + sizeof(struct heap_phy [1]));
         tmp->phy.prev              = curr->phy.prev;
     } else {                                                                    /* Previous and next blocks are used    */
         struct heap_block *     sentinel = mem_class->base;
 
         curr->free.next            = sentinel->free.next;
-        curr->free.prev            = sentinel;
-        curr->free.prev->free.next = curr;
-        curr->free.next->free.prev = curr;
+        curr->free.prev            = LINK(mem_class, sentinel);
+        BLOCK(mem_class, curr->free.prev)->free.next = LINK(mem_class, curr);
+        BLOCK(mem_class, curr->free.next)->free.prev = LINK(mem_class, curr);
+    }
+}
+
+
+
+static void heap_setup(
+    struct nheap *              heap,
+    void *                      storage,
+    size_t                      size)
+{
+    size = NALIGN(size, NCPU_DATA_ALIGNMENT);
+                                            /* Sentinel is the last element   */
+    heap->mem_class.base     = (struct heap_block *)((uint8_t *)storage + size) - 1;
+    heap->mem_class.size     = size;
+    heap->mem_class.size    -= sizeof(struct heap_block [1]);
+    heap->mem_class.size    -= sizeof(struct heap_phy [1]);
+    heap->mem_class.size    -= HEAP_IMAGE_SIZE;
+    heap->mem_class.free     = heap->mem_class.size;
+    heap->mem_class.vf_alloc = heap_alloc_i;
+    heap->mem_class.vf_free  = heap_free_i;
+
+#if (CONFIG_HEAP_CHECK == 1)
+    heap->check_cursor = NULL;
+#endif
+#if (CONFIG_HEAP_CHECK == 1) || (CONFIG_HEAP_CANARY == 1)
+    heap->corrupted    = 0u;
+#endif
+#if (CONFIG_HEAP_FRONTEND == 1)
+    {
+        uint_fast8_t            class_no;
+
+        for (class_no = 0u; class_no < CONFIG_HEAP_FE_CLASSES; class_no++) {
+            heap->fe_free[class_no] = NULL;
+        }
     }
+#endif
+}
+
+
+
+static bool heap_walk_i(
+    struct nmem *               mem_class,
+    void                     (* fn)(void *, void *, size_t, bool),
+    void *                      arg)
+{
+    struct heap_block *         sentinel;
+    struct heap_block *         curr;
+    size_t                      nfree;
+    size_t                      nlisted;
+
+    sentinel = mem_class->base;
+
+    if (sentinel->phy.size != -1) {
+
+        return (false);
+    }
+    nfree = 0u;
+    curr  = block_begin(mem_class);
+
+    while (curr != sentinel) {                                                  /* Walk the physical block chain.     */
+
+        if (!block_is_valid(mem_class, curr)) {
+
+            return (false);
+        }
+
+        if (curr->phy.size > 0) {
+            nfree++;
+        }
+
+        if (fn != NULL) {
+#if (CONFIG_HEAP_CANARY == 1)
+            fn(arg, (void *)&curr->free,
+                curr->phy.size > 0 ? BLOCK_SIZE(curr) : *block_trailer(curr),
+                curr->phy.size > 0);
+#else
+            fn(arg, (void *)&curr->free, BLOCK_SIZE(curr), curr->phy.size > 0);
+#endif
+        }
+        curr = block_next(curr);
+    }
+    nlisted = 0u;
+    curr    = BLOCK(mem_class, sentinel->free.next);
+
+    while (curr != sentinel) {                                                  /* Free list must contain exactly the */
+                                                                                /* free blocks found above.           */
+        if (!block_is_in_range(mem_class, curr) || (curr->phy.size <= 0) ||
+            (++nlisted > nfree)) {
+
+            return (false);
+        }
+        curr = BLOCK(mem_class, curr->free.next);
+    }
+
+    if (nlisted != nfree) {
+
+        return (false);
+    }
+
+    return (true);
+}
+
+
+#if (CONFIG_HEAP_FRONTEND == 1)
+static void * fe_refill_i(
+    struct nheap *              heap,
+    uint_fast8_t                class_no)
+{
+    size_t                      slot_size;
+    size_t                      nslots;
+    uint8_t *                   chunk;
+
+    slot_size = HEAP_FE_SLOT_SIZE(class_no);
+    nslots    = CONFIG_HEAP_FE_REFILL;
+    chunk     = block_alloc_i(&heap->mem_class, slot_size * nslots);
+
+    if ((chunk == NULL) && (nslots != 1u)) {                                    /* Not enough memory for a bulk refill*/
+        nslots = 1u;                                                            /* try to get at least one object.    */
+        chunk  = block_alloc_i(&heap->mem_class, slot_size);
+    }
+
+    while (chunk != NULL) {                                                     /* Carve the chunk into objects and   */
+        void *                  mem;                                            /* push them to the class free list.  */
+
+        mem                      = chunk + HEAP_FE_HEADER_SIZE;
+        *MEM_TO_TAG(mem)         = HEAP_FE_TAG_FREE;
+        *(void **)mem            = heap->fe_free[class_no];
+        heap->fe_free[class_no]  = mem;
+        chunk                   += slot_size;
+
+        if (--nslots == 0u) {
+            break;
+        }
+    }
+
+    return (heap->fe_free[class_no]);
+}
+
+
+
+static void * fe_alloc_i(
+    struct nheap *              heap,
+    size_t                      size)
+{
+    uint_fast8_t                class_no;
+    void *                      mem;
+
+    class_no = (uint_fast8_t)((size - 1u) / CONFIG_HEAP_FE_GRANULE);
+    mem      = heap->fe_free[class_no];
+
+    if (mem == NULL) {
+        mem = fe_refill_i(heap, class_no);
+
+        if (mem == NULL) {
+
+            return (NULL);
+        }
+    }
+    heap->fe_free[class_no] = *(void **)mem;
+    *MEM_TO_TAG(mem)        = HEAP_FE_TAG(class_no);
+
+    return (mem);
+}
+
+
+
+static void fe_free_i(
+    struct nheap *              heap,
+    void *                      mem)
+{
+    ncpu_ssize                  tag;
+    uint_fast8_t                class_no;
+
+    tag = *MEM_TO_TAG(mem);
+
+#if (CONFIG_HEAP_CHECK == 1)
+    if (tag <= HEAP_FE_TAG_FREE) {                                              /* Freed object or free regular block */
+        heap->corrupted++;
+        NASSERT_ALWAYS("corrupted or double freed heap object");
+
+        return;
+    }
+#else
+    NREQUIRE(NAPI_OBJECT, tag > HEAP_FE_TAG_FREE);
+#endif
+    class_no = (uint_fast8_t)(NCPU_SSIZE_MAX - tag);                            /* Range checked above                */
+
+    *MEM_TO_TAG(mem)        = HEAP_FE_TAG_FREE;
+    *(void **)mem           = heap->fe_free[class_no];
+    heap->fe_free[class_no] = mem;
+}
+#endif
+
+
+
+static void * heap_alloc_i(
+    struct nmem *               mem_class,
+    size_t                      size)
+{
+    NREQUIRE(NAPI_POINTER, mem_class != NULL);
+    NREQUIRE(NAPI_OBJECT,  mem_class->signature == HEAP_MEM_SIGNATURE);
+    NREQUIRE(NAPI_RANGE,   (size != 0u) && (size < NCPU_SSIZE_MAX));
+
+#if (CONFIG_HEAP_FRONTEND == 1)
+    if (size <= NHEAP_FE_MAX_SIZE) {
+
+        return (fe_alloc_i(CONTAINER_OF(mem_class, struct nheap, mem_class),
+            size));
+    }
+#endif
+
+    return (block_alloc_i(mem_class, size));
+}
+
+
+
+static void heap_free_i(
+    struct nmem *               mem_class,
+    void *                      mem)
+{
+    NREQUIRE(NAPI_POINTER, mem_class != NULL);
+    NREQUIRE(NAPI_OBJECT,  mem_class->signature == HEAP_MEM_SIGNATURE);
+    NREQUIRE(NAPI_POINTER, mem != NULL);
+
+#if (CONFIG_HEAP_FRONTEND == 1)
+    if (*MEM_TO_TAG(mem) >= 0) {                                                /* Small objects and free blocks      */
+        fe_free_i(CONTAINER_OF(mem_class, struct nheap, mem_class), mem);
+
+        return;
+    }
+#endif
+    block_free_i(mem_class, mem);
 }
 
 /*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
@@ -214,32 +835,112 @@ void nheap_init(
     NREQUIRE(NAPI_POINTER, heap != NULL);
     NREQUIRE(NAPI_OBJECT,  heap->mem_class.signature != HEAP_MEM_SIGNATURE);
     NREQUIRE(NAPI_POINTER, storage != NULL);
-    NREQUIRE(NAPI_RANGE,   size > sizeof(struct heap_block [2]));
+    NREQUIRE(NAPI_RANGE,   size > sizeof(struct heap_block [2]) + HEAP_IMAGE_SIZE);
     NREQUIRE(NAPI_RANGE,   size < NCPU_SSIZE_MAX);
 
-    size = NALIGN(size, NCPU_DATA_ALIGNMENT);
-                                            /* Sentinel is the last element   */
-    sentinel = (struct heap_block *)((uint8_t *)storage + size) - 1;
-    begin    = (struct heap_block *)storage;
-    begin->phy.size  = (ncpu_ssize)size;
-    begin->phy.size -= (ncpu_ssize)sizeof(struct heap_block [1]);
-    begin->phy.size -= (ncpu_ssize)sizeof(struct heap_phy [1]);
-    begin->phy.prev  = sentinel;
-    begin->free.next = sentinel;
-    begin->free.prev = sentinel;
+    heap_setup(heap, storage, size);
+    sentinel = heap->mem_class.base;
+    begin    = block_begin(&heap->mem_class);
+    begin->phy.size  = (ncpu_ssize)heap->mem_class.size;
+    begin->phy.prev  = LINK(&heap->mem_class, sentinel);
+    begin->free.next = LINK(&heap->mem_class, sentinel);
+    begin->free.prev = LINK(&heap->mem_class, sentinel);
 
     sentinel->phy.size   = -1;
-    sentinel->phy.prev   = begin;
-    sentinel->free.next  = begin;
-    sentinel->free.prev  = begin;
-    heap->mem_class.base = sentinel;
-    heap->mem_class.size = (size_t)begin->phy.size;
-    heap->mem_class.free = (size_t)begin->phy.size;
-    heap->mem_class.vf_alloc = heap_alloc_i;
-    heap->mem_class.vf_free  = heap_free_i;
+    sentinel->phy.prev   = LINK(&heap->mem_class, begin);
+    sentinel->free.next  = LINK(&heap->mem_class, begin);
+    sentinel->free.prev  = LINK(&heap->mem_class, begin);
+
+#if (CONFIG_HEAP_OFFSET_LINKS == 1)
+    {
+        struct heap_image *     image = storage;
+
+        image->magic      = HEAP_IMAGE_MAGIC;
+        image->block_size = (uint32_t)sizeof(struct heap_block);
+        image->size       = size;
+        image->root       = 0;
+    }
+#endif
+    NOBLIGATION(heap->mem_class.signature = HEAP_MEM_SIGNATURE);
+}
+
+
+
+#if (CONFIG_HEAP_OFFSET_LINKS == 1)
+bool nheap_attach(
+    struct nheap *              heap,
+    void *                      storage,
+    size_t                      size)
+{
+    const struct heap_image *   image = storage;
+
+    NREQUIRE(NAPI_POINTER, heap != NULL);
+    NREQUIRE(NAPI_OBJECT,  heap->mem_class.signature != HEAP_MEM_SIGNATURE);
+    NREQUIRE(NAPI_POINTER, storage != NULL);
+    NREQUIRE(NAPI_RANGE,   size > sizeof(struct heap_block [2]) + HEAP_IMAGE_SIZE);
+    NREQUIRE(NAPI_RANGE,   size < NCPU_SSIZE_MAX);
 
+    if ((image->magic      != HEAP_IMAGE_MAGIC) ||
+        (image->block_size != (uint32_t)sizeof(struct heap_block)) ||
+        (image->size       != size)) {
+
+        return (false);
+    }
+    heap_setup(heap, storage, size);
+
+    if (!heap_walk_i(&heap->mem_class, NULL, NULL)) {                           /* Never trust the stored image.      */
+        heap->mem_class.base = NULL;
+
+        return (false);
+    }
     NOBLIGATION(heap->mem_class.signature = HEAP_MEM_SIGNATURE);
+
+    return (true);
+}
+
+
+
+void nheap_set_root(
+    struct nheap *              heap,
+    void *                      root)
+{
+    struct heap_image *         image;
+
+    NREQUIRE(NAPI_POINTER, heap != NULL);
+    NREQUIRE(NAPI_OBJECT,  heap->mem_class.signature == HEAP_MEM_SIGNATURE);
+
+    image = (struct heap_image *)
+        ((uint8_t *)block_begin(&heap->mem_class) - HEAP_IMAGE_SIZE);
+
+    if (root != NULL) {
+        image->root = LINK(&heap->mem_class, root);
+    } else {
+        image->root = 0;
+    }
+}
+
+
+
+void * nheap_get_root(
+    const struct nheap *        heap)
+{
+    const struct heap_image *   image;
+
+    NREQUIRE(NAPI_POINTER, heap != NULL);
+    NREQUIRE(NAPI_OBJECT,  heap->mem_class.signature == HEAP_MEM_SIGNATURE);
+
+    image = (const struct heap_image *)
+        ((uint8_t *)block_begin(&heap->mem_class) - HEAP_IMAGE_SIZE);
+
+    if (image->root != 0) {
+
+        return ((void *)BLOCK(&heap->mem_class, image->root));
+    } else {
+
+        return (NULL);
+    }
 }
+#endif
 
 
 
@@ -260,7 +961,13 @@ void * nheap_alloc_i(
     struct nheap *              heap,
     size_t                      size)
 {
-    return (heap_alloc_i(&heap->mem_class, size));
+    void *                      mem;
+    NMEM_PROFILE_BEGIN(stamp);
+
+    mem = heap_alloc_i(&heap->mem_class, size);
+    NMEM_PROFILE_ALLOC_I(&heap->mem_class, size, mem, stamp);
+
+    return (mem);
 }
 
 
@@ -271,9 +978,11 @@ void * nheap_alloc(
 {
     ncore_lock                   sys_lock;
     void *                      mem;
+    NMEM_PROFILE_BEGIN(stamp);
 
     ncore_lock_enter(&sys_lock);
     mem = heap_alloc_i(&heap->mem_class, size);
+    NMEM_PROFILE_ALLOC_I(&heap->mem_class, size, mem, stamp);
     ncore_lock_exit(&sys_lock);
 
     return (mem);
@@ -285,7 +994,10 @@ void nheap_free_i(
     struct nheap *              heap,
     void *                      mem)
 {
+    NMEM_PROFILE_BEGIN(stamp);
+
     heap_free_i(&heap->mem_class, mem);
+    NMEM_PROFILE_FREE_I(&heap->mem_class, stamp);
 }
 
 
@@ -295,11 +1007,102 @@ void nheap_free(
     void *                      mem)
 {
     ncore_lock                   sys_lock;
+    NMEM_PROFILE_BEGIN(stamp);
 
     ncore_lock_enter(&sys_lock);
     heap_free_i(&heap->mem_class, mem);
+    NMEM_PROFILE_FREE_I(&heap->mem_class, stamp);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+
+#if (CONFIG_HEAP_CHECK == 1) || (CONFIG_HEAP_CANARY == 1)
+uint32_t nheap_corrupted(
+    const struct nheap *        heap)
+{
+    NREQUIRE(NAPI_POINTER, heap != NULL);
+    NREQUIRE(NAPI_OBJECT,  heap->mem_class.signature == HEAP_MEM_SIGNATURE);
+
+    return (heap->corrupted);
+}
+#endif
+
+
+
+bool nheap_walk(
+    struct nheap *              heap,
+    void                     (* fn)(void *, void *, size_t, bool),
+    void *                      arg)
+{
+    ncore_lock                  sys_lock;
+    bool                        is_valid;
+
+    NREQUIRE(NAPI_POINTER, heap != NULL);
+    NREQUIRE(NAPI_OBJECT,  heap->mem_class.signature == HEAP_MEM_SIGNATURE);
+
+    ncore_lock_enter(&sys_lock);
+    is_valid = heap_walk_i(&heap->mem_class, fn, arg);
+    ncore_lock_exit(&sys_lock);
+
+    return (is_valid);
+}
+
+
+
+#if (CONFIG_HEAP_CHECK == 1)
+bool nheap_check_i(
+    struct nheap *              heap,
+    uint_fast16_t               nblocks)
+{
+    struct heap_block *         sentinel;
+    struct heap_block *         curr;
+
+    NREQUIRE(NAPI_POINTER, heap != NULL);
+    NREQUIRE(NAPI_OBJECT,  heap->mem_class.signature == HEAP_MEM_SIGNATURE);
+
+    sentinel = heap->mem_class.base;
+    curr     = heap->check_cursor;
+
+    if (curr == NULL) {
+        curr = block_begin(&heap->mem_class);
+    }
+
+    while (nblocks-- != 0u) {
+
+        if (!block_is_valid(&heap->mem_class, curr)) {
+            heap->check_cursor = curr;                                          /* Report the same block again.       */
+
+            return (false);
+        }
+        curr = block_next(curr);
+
+        if (curr == sentinel) {                                                 /* Wrap around at the end of heap.    */
+            curr = block_begin(&heap->mem_class);
+        }
+    }
+    heap->check_cursor = curr;
+
+    return (true);
+}
+
+
+
+bool nheap_check(
+    struct nheap *              heap,
+    uint_fast16_t               nblocks)
+{
+    ncore_lock                  sys_lock;
+    bool                        is_valid;
+
+    ncore_lock_enter(&sys_lock);
+    is_valid = nheap_check_i(heap, nblocks);
     ncore_lock_exit(&sys_lock);
+
+    return (is_valid);
 }
+#endif
 
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//** @} *//*********************************************
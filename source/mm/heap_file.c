@@ -0,0 +1,154 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Persistent file backed heap implementation
+ * @addtogroup  mem_heap_file
+ *********************************************************************//** @{ */
+/**@defgroup    mem_heap_file_impl Implementation
+ * @brief       Persistent file backed heap implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include "mm/heap.h"
+
+#if (CONFIG_HEAP_OFFSET_LINKS == 1)
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "mm/heap_file.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Persistent Heap", "Nenad Radulovic");
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+int nheap_file_open(
+    struct nheap_file *         heap_file,
+    const char *                path,
+    size_t                      size)
+{
+    struct stat                 file_stat;
+    int                         retval;
+
+    NREQUIRE(NAPI_POINTER, heap_file != NULL);
+    NREQUIRE(NAPI_POINTER, path != NULL);
+
+    heap_file->fd = open(path, O_RDWR | O_CREAT, 0600);
+
+    if (heap_file->fd == -1) {
+
+        return (NHEAP_FILE_ERROR);
+    }
+
+    if (fstat(heap_file->fd, &file_stat) == -1) {
+        goto FAILURE;
+    }
+
+    if ((size_t)file_stat.st_size != size) {                                    /* New file or file of different size */
+        retval = NHEAP_FILE_CREATED;
+
+        if (ftruncate(heap_file->fd, (off_t)size) == -1) {
+            goto FAILURE;
+        }
+    } else {
+        retval = NHEAP_FILE_ATTACHED;
+    }
+    heap_file->storage = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+        heap_file->fd, 0);
+
+    if (heap_file->storage == MAP_FAILED) {
+        goto FAILURE;
+    }
+    heap_file->size = size;
+    memset(&heap_file->heap, 0, sizeof(heap_file->heap));
+
+    if (retval == NHEAP_FILE_ATTACHED) {
+
+        if (!nheap_attach(&heap_file->heap, heap_file->storage, size)) {
+            memset(&heap_file->heap, 0, sizeof(heap_file->heap));
+            retval = NHEAP_FILE_RECREATED;
+        }
+    }
+
+    if (retval != NHEAP_FILE_ATTACHED) {
+        nheap_init(&heap_file->heap, heap_file->storage, size);
+    }
+
+    return (retval);
+FAILURE:
+    close(heap_file->fd);
+    heap_file->fd = -1;
+
+    return (NHEAP_FILE_ERROR);
+}
+
+
+
+int nheap_file_sync(
+    struct nheap_file *         heap_file)
+{
+    NREQUIRE(NAPI_POINTER, heap_file != NULL);
+
+    if (msync(heap_file->storage, heap_file->size, MS_SYNC) == -1) {
+
+        return (NHEAP_FILE_ERROR);
+    }
+
+    return (0);
+}
+
+
+
+void nheap_file_close(
+    struct nheap_file *         heap_file)
+{
+    NREQUIRE(NAPI_POINTER, heap_file != NULL);
+
+    nheap_term(&heap_file->heap);
+    (void)msync(heap_file->storage, heap_file->size, MS_SYNC);
+    (void)munmap(heap_file->storage, heap_file->size);
+    (void)close(heap_file->fd);
+    heap_file->storage = NULL;
+    heap_file->fd      = -1;
+}
+
+#endif /* (CONFIG_HEAP_OFFSET_LINKS == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of heap_file.c
+ ******************************************************************************/
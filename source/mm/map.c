@@ -0,0 +1,291 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Mapped backing storage implementation
+ * @addtogroup  mem_map
+ *********************************************************************//** @{ */
+/**@defgroup    mem_map_impl Implementation
+ * @brief       Mapped backing storage implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "mm/map.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#if !defined(MPOL_BIND)
+#define MPOL_BIND                       2
+#endif
+
+#if !defined(MPOL_MF_MOVE)
+#define MPOL_MF_MOVE                    (0x1u << 1)
+#endif
+
+#define MAP_ROUND_UP(size, unit)                                                \
+    (((size) + (unit) - 1u) & ~((unit) - 1u))
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Mapped Storage", "Nenad Radulovic");
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+/**@brief       Map anonymous memory aligned to huge page size
+ * @details     Transparent huge pages are used by the kernel only for huge page
+ *              aligned ranges, so a bigger area is mapped and trimmed.
+ */
+static void * map_aligned(
+    size_t                      size)
+{
+    uint8_t *                   area;
+    uint8_t *                   aligned;
+    size_t                      head;
+    size_t                      tail;
+
+    area = mmap(NULL, size + CONFIG_MEM_MAP_HUGE_PAGE_SIZE,
+        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (area == MAP_FAILED) {
+
+        return (MAP_FAILED);
+    }
+    aligned = (uint8_t *)MAP_ROUND_UP((uintptr_t)area,
+        (uintptr_t)CONFIG_MEM_MAP_HUGE_PAGE_SIZE);
+    head    = (size_t)(aligned - area);
+    tail    = CONFIG_MEM_MAP_HUGE_PAGE_SIZE - head;
+
+    if (head != 0u) {
+        (void)munmap(area, head);
+    }
+
+    if (tail != 0u) {
+        (void)munmap(aligned + size, tail);
+    }
+
+    return (aligned);
+}
+
+
+
+static bool map_bind(
+    void *                      storage,
+    size_t                      size,
+    uint_fast8_t                node)
+{
+#if defined(SYS_mbind)
+    unsigned long               mask;
+
+    if (node >= (sizeof(mask) * 8u)) {
+
+        return (false);
+    }
+    mask = 0x1ul << node;
+
+    return (syscall(SYS_mbind, storage, size, MPOL_BIND, &mask,
+        sizeof(mask) * 8u + 1u, MPOL_MF_MOVE) == 0);                            /* Kernel uses maxnode - 1 bits       */
+#else
+    (void)storage;
+    (void)size;
+    (void)node;
+
+    return (false);
+#endif
+}
+
+
+
+static void map_prefault(
+    void *                      storage,
+    size_t                      size,
+    size_t                      page_size)
+{
+    volatile uint8_t *          page;
+    size_t                      offset;
+
+    page = storage;
+
+    for (offset = 0u; offset < size; offset += page_size) {
+        page[offset] = 0u;
+    }
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+bool nmem_map_alloc(
+    struct nmem_map *           map,
+    size_t                      size,
+    uint32_t                    attr,
+    uint_fast8_t                node)
+{
+    size_t                      page_size;
+
+    NREQUIRE(NAPI_POINTER, map != NULL);
+    NREQUIRE(NAPI_RANGE,   size != 0u);
+
+    map->storage = MAP_FAILED;
+    map->attr    = 0u;
+
+#if defined(MAP_HUGETLB)
+    if ((attr & NMEM_MAP_HUGE) != 0u) {
+        map->size    = MAP_ROUND_UP(size, CONFIG_MEM_MAP_HUGE_PAGE_SIZE);
+        map->storage = mmap(NULL, map->size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (map->storage != MAP_FAILED) {
+            map->attr |= NMEM_MAP_HUGE;
+        }
+    }
+#endif
+
+    if (map->storage == MAP_FAILED) {                                           /* No explicit huge pages, use normal */
+
+        if ((attr & (NMEM_MAP_HUGE | NMEM_MAP_THP_ADVISE)) != 0u) {
+            map->size    = MAP_ROUND_UP(size, CONFIG_MEM_MAP_HUGE_PAGE_SIZE);
+            map->storage = map_aligned(map->size);
+#if defined(MADV_HUGEPAGE)
+            if ((map->storage != MAP_FAILED) &&
+                (madvise(map->storage, map->size, MADV_HUGEPAGE) == 0)) {
+                map->attr |= NMEM_MAP_THP_ADVISE;
+            }
+#endif
+        } else {
+            page_size    = (size_t)sysconf(_SC_PAGESIZE);
+            map->size    = MAP_ROUND_UP(size, page_size);
+            map->storage = mmap(NULL, map->size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+    }
+
+    if (map->storage == MAP_FAILED) {
+        map->storage = NULL;
+        map->size    = 0u;
+
+        return (false);
+    }
+
+    if (((attr & NMEM_MAP_NODE) != 0u) &&
+        map_bind(map->storage, map->size, node)) {
+        map->attr |= NMEM_MAP_NODE;
+    }
+
+    if ((attr & NMEM_MAP_PREFAULT) != 0u) {
+
+        if ((map->attr & NMEM_MAP_HUGE) != 0u) {
+            page_size = CONFIG_MEM_MAP_HUGE_PAGE_SIZE;
+        } else {
+            page_size = (size_t)sysconf(_SC_PAGESIZE);
+        }
+        map_prefault(map->storage, map->size, page_size);
+        map->attr |= NMEM_MAP_PREFAULT;
+    }
+
+    return (true);
+}
+
+
+
+void nmem_map_free(
+    struct nmem_map *           map)
+{
+    NREQUIRE(NAPI_POINTER, map != NULL);
+    NREQUIRE(NAPI_OBJECT,  map->storage != NULL);
+
+    (void)munmap(map->storage, map->size);
+    map->storage = NULL;
+    map->size    = 0u;
+    map->attr    = 0u;
+}
+
+
+
+bool nheap_init_mapped(
+    struct nheap *              heap,
+    struct nmem_map *           map,
+    size_t                      size,
+    uint32_t                    attr,
+    uint_fast8_t                node)
+{
+    if (!nmem_map_alloc(map, size, attr, node)) {
+
+        return (false);
+    }
+    nheap_init(heap, map->storage, map->size);
+
+    return (true);
+}
+
+
+
+bool npool_init_mapped(
+    struct npool *              pool,
+    struct nmem_map *           map,
+    size_t                      array_size,
+    size_t                      block_size,
+    uint32_t                    attr,
+    uint_fast8_t                node)
+{
+    if (!nmem_map_alloc(map, array_size, attr, node)) {
+
+        return (false);
+    }
+    npool_init(pool, map->storage, map->size, block_size);
+
+    return (true);
+}
+
+
+
+bool nstatic_init_mapped(
+    struct nstatic *            static_mem,
+    struct nmem_map *           map,
+    size_t                      size,
+    uint32_t                    attr,
+    uint_fast8_t                node)
+{
+    if (!nmem_map_alloc(map, size, attr, node)) {
+
+        return (false);
+    }
+    nstatic_init(static_mem, map->storage, map->size);
+
+    return (true);
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of map.c
+ ******************************************************************************/
@@ -32,6 +32,7 @@
 
 #include "port/core.h"
 #include "mm/mem.h"
+#include "mm/profile.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
 /*======================================================  LOCAL DATA TYPES  ==*/
@@ -49,9 +50,11 @@ void * nmem_alloc(
 {
     ncore_lock                   sys_lock;
     void *                      mem_storage;
+    NMEM_PROFILE_BEGIN(stamp);
 
     ncore_lock_enter(&sys_lock);
     mem_storage = nmem_alloc_i(mem, size);
+    NMEM_PROFILE_ALLOC_I(mem, size, mem_storage, stamp);
     ncore_lock_exit(&sys_lock);
 
     return (mem_storage);
@@ -64,9 +67,11 @@ void nmem_free(
     void *                      mem_storage)
 {
     ncore_lock                   sys_lock;
+    NMEM_PROFILE_BEGIN(stamp);
 
     ncore_lock_enter(&sys_lock);
     nmem_free_i(mem, mem_storage);
+    NMEM_PROFILE_FREE_I(mem, stamp);
     ncore_lock_exit(&sys_lock);
 }
 
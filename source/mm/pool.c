@@ -34,6 +34,7 @@
 #include "shared/component.h"
 #include "shared/bitop.h"
 #include "mm/pool.h"
+#include "mm/profile.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
 
@@ -154,7 +155,13 @@ void npool_init(
 void * npool_alloc_i(
     struct npool *              pool)
 {
-    return (pool_alloc_i(&pool->mem_class, 0));
+    void *                      mem;
+    NMEM_PROFILE_BEGIN(stamp);
+
+    mem = pool_alloc_i(&pool->mem_class, 0);
+    NMEM_PROFILE_ALLOC_I(&pool->mem_class, pool->mem_class.size, mem, stamp);
+
+    return (mem);
 }
 
 
@@ -164,9 +171,11 @@ void * npool_alloc(
 {
     ncore_lock                   sys_lock;
     void *                      mem;
+    NMEM_PROFILE_BEGIN(stamp);
 
     ncore_lock_enter(&sys_lock);
     mem = pool_alloc_i(&pool->mem_class, 0);
+    NMEM_PROFILE_ALLOC_I(&pool->mem_class, pool->mem_class.size, mem, stamp);
     ncore_lock_exit(&sys_lock);
 
     return (mem);
@@ -178,7 +187,10 @@ void npool_free_i(
     struct npool *              pool,
     void *                      mem)
 {
+    NMEM_PROFILE_BEGIN(stamp);
+
     pool_free_i(&pool->mem_class, mem);
+    NMEM_PROFILE_FREE_I(&pool->mem_class, stamp);
 }
 
 
@@ -188,9 +200,11 @@ void npool_free(
     void *                      mem)
 {
     ncore_lock                 sys_lock;
+    NMEM_PROFILE_BEGIN(stamp);
 
     ncore_lock_enter(&sys_lock);
     pool_free_i(&pool->mem_class, mem);
+    NMEM_PROFILE_FREE_I(&pool->mem_class, stamp);
     ncore_lock_exit(&sys_lock);
 }
 
@@ -0,0 +1,240 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Memory allocation profiling implementation
+ * @addtogroup  mem_profile
+ *********************************************************************//** @{ */
+/**@defgroup    mem_profile_impl Implementation
+ * @brief       Memory allocation profiling implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "mm/profile.h"
+
+#if !defined(__GNUC__)
+#include <stdatomic.h>
+#endif
+
+#if (CONFIG_MEM_PROFILE == 1)
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define RING_MASK                       (CONFIG_MEM_PROFILE_RECORDS - 1u)
+
+/**@brief       Order the copy of a record before the following @c head re-check
+ * @details     Without it the compiler or the CPU may load @c head first and
+ *              accept a record which was overwritten afterwards.
+ */
+#if defined(__GNUC__)
+#define READ_BARRIER()                  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#else
+#define READ_BARRIER()                  atomic_thread_fence(memory_order_acquire)
+#endif
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       Profiling record
+ */
+struct profile_record
+{
+    const void *                caller;
+    const struct nmem *         mem;
+    size_t                      size;
+    nstamp                      latency;
+    uint8_t                     op;
+};
+
+/**@brief       Profiling ring buffer
+ * @details     The @c head counter is never wrapped, only the index into the
+ *              record array is masked. This way the reader can detect records
+ *              which were overwritten while it was reading them.
+ */
+struct profile_ring
+{
+    struct profile_record       record[CONFIG_MEM_PROFILE_RECORDS];
+    volatile uint32_t           head;
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+
+static struct nmem_profile_site * find_site(
+    struct nmem_profile_dump *  dump,
+    const void *                caller);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Memory Allocation Profiling", "Nenad Radulovic");
+
+static struct profile_ring      g_profile_ring;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static struct nmem_profile_site * find_site(
+    struct nmem_profile_dump *  dump,
+    const void *                caller)
+{
+    size_t                      count;
+    struct nmem_profile_site *  site;
+
+    for (count = 0u; count < dump->site_count; count++) {
+
+        if (dump->site[count].caller == caller) {
+
+            return (&dump->site[count]);
+        }
+    }
+
+    if (dump->site_count == dump->site_size) {
+
+        return (NULL);
+    }
+    site = &dump->site[dump->site_count++];
+    site->caller        = caller;
+    site->allocs        = 0u;
+    site->failures      = 0u;
+    site->frees         = 0u;
+    site->bytes         = 0u;
+    site->latency_total = 0u;
+    site->latency_max   = 0u;
+
+    return (site);
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+void nmem_profile_record_i(
+    const struct nmem *         mem,
+    uint_fast8_t                op,
+    const void *                caller,
+    size_t                      size,
+    nstamp                      begin)
+{
+    struct profile_ring *       ring = &g_profile_ring;
+    struct profile_record *     record;
+    uint32_t                    head;
+
+    head            = ring->head;
+    record          = &ring->record[head & RING_MASK];
+    record->caller  = caller;
+    record->mem     = mem;
+    record->size    = size;
+    record->op      = (uint8_t)op;
+    record->latency = nstamp_delta(begin, nstamp_get());
+    ring->head      = head + 1u;                /* Publish the record.        */
+}
+
+
+
+void nmem_profile_dump(
+    const struct nmem *         mem,
+    struct nmem_profile_dump *  dump)
+{
+    struct profile_ring *       ring = &g_profile_ring;
+    uint32_t                    head;
+    uint32_t                    index;
+    uint_fast8_t                bucket;
+
+    NREQUIRE(NAPI_POINTER, dump != NULL);
+    NREQUIRE(NAPI_POINTER, dump->site != NULL);
+
+    dump->site_count = 0u;
+    dump->dropped    = 0u;
+
+    for (bucket = 0u; bucket < NMEM_PROFILE_SIZE_BUCKETS; bucket++) {
+        dump->size_hist[bucket] = 0u;
+    }
+    head  = ring->head;
+    index = head - ((head < RING_MASK) ? head : RING_MASK);
+
+    for (; index != head; index++) {
+        struct profile_record   record;
+        struct nmem_profile_site * site;
+
+        record = ring->record[index & RING_MASK];
+        READ_BARRIER();
+
+        if ((uint32_t)(ring->head - index) >= CONFIG_MEM_PROFILE_RECORDS) {     /* Overwritten while we were reading  */
+            continue;
+        }
+
+        if ((mem != NULL) && (record.mem != mem)) {
+            continue;
+        }
+        site = find_site(dump, record.caller);
+
+        if (site == NULL) {
+            dump->dropped++;
+
+            continue;
+        }
+
+        switch (record.op) {
+            case NMEM_PROFILE_ALLOC: {
+                site->allocs++;
+                site->bytes += record.size;
+                bucket = nstamp_log2_bucket((uint32_t)record.size,
+                    NMEM_PROFILE_SIZE_BUCKETS);
+                dump->size_hist[bucket]++;
+                break;
+            }
+            case NMEM_PROFILE_FAIL: {
+                site->failures++;
+                break;
+            }
+            default : {
+                site->frees++;
+                break;
+            }
+        }
+        site->latency_total += record.latency;
+
+        if (site->latency_max < record.latency) {
+            site->latency_max = record.latency;
+        }
+    }
+}
+
+
+
+void nmem_profile_clear(void)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    g_profile_ring.head = 0u;
+    ncore_lock_exit(&sys_lock);
+}
+
+#endif /* (CONFIG_MEM_PROFILE == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of profile.c
+ ******************************************************************************/
@@ -34,6 +34,7 @@
 #include "shared/component.h"
 #include "shared/bitop.h"
 #include "mm/static.h"
+#include "mm/profile.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
 
@@ -120,7 +121,13 @@ void * nstatic_alloc_i(
     struct nstatic *            static_mem,
     size_t                      size)
 {
-    return (static_alloc_i(&static_mem->mem_class, size));
+    void *                      mem;
+    NMEM_PROFILE_BEGIN(stamp);
+
+    mem = static_alloc_i(&static_mem->mem_class, size);
+    NMEM_PROFILE_ALLOC_I(&static_mem->mem_class, size, mem, stamp);
+
+    return (mem);
 }
 
 
@@ -131,9 +138,11 @@ void * nstatic_alloc(
 {
     ncore_lock                   sys_lock;
     void *                      mem;
+    NMEM_PROFILE_BEGIN(stamp);
 
     ncore_lock_enter(&sys_lock);
     mem = static_alloc_i(&static_mem->mem_class, size);
+    NMEM_PROFILE_ALLOC_I(&static_mem->mem_class, size, mem, stamp);
     ncore_lock_exit(&sys_lock);
 
     return (mem);
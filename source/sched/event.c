@@ -0,0 +1,245 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Events and thread mailboxes implementation
+ * @addtogroup  sched_event
+ *********************************************************************//** @{ */
+/**@defgroup    sched_event_impl Implementation
+ * @brief       Events and thread mailboxes implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "sched/event.h"
+
+#if (CONFIG_SCHED_EVENT == 1)
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define MAILBOX_MASK                    (CONFIG_SCHED_EVENT_MAILBOX_SIZE - 1u)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Events", "Nenad Radulovic");
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static struct nevent * mailbox_pop(
+    struct nthread *            thread)
+{
+    struct nevent *             event;
+
+    event = thread->mailbox[thread->mailbox_head];
+    thread->mailbox_head = (uint8_t)((thread->mailbox_head + 1u) & MAILBOX_MASK);
+    thread->mailbox_count--;
+
+    return (event);
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+
+
+bool nevent_mailbox_push_i(
+    struct nthread *            thread,
+    struct nevent *             event)
+{
+    if (thread->mailbox_count == CONFIG_SCHED_EVENT_MAILBOX_SIZE) {
+
+        return (false);
+    }
+    thread->mailbox[(thread->mailbox_head + thread->mailbox_count) &
+        MAILBOX_MASK] = event;
+    thread->mailbox_count++;
+
+    return (true);
+}
+
+
+
+void nevent_mailbox_term_i(
+    struct nthread *            thread)
+{
+    while (thread->mailbox_count != 0u) {
+        nevent_release_i(mailbox_pop(thread));
+    }
+    thread->mailbox_head = 0u;
+}
+
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+void nevent_init(
+    struct nevent *             event,
+    uint16_t                    id)
+{
+    NREQUIRE(NAPI_POINTER, event != NULL);
+
+    event->mem = NULL;
+    event->id  = id;
+    event->ref = 1u;
+}
+
+
+
+struct nevent * nevent_create_i(
+    struct nmem *               mem,
+    size_t                      size,
+    uint16_t                    id)
+{
+    struct nevent *             event;
+
+    NREQUIRE(NAPI_POINTER, mem != NULL);
+    NREQUIRE(NAPI_RANGE,   size >= sizeof(struct nevent));
+
+    event = nmem_alloc_i(mem, size);
+
+    if (event != NULL) {
+        event->mem = mem;
+        event->id  = id;
+        event->ref = 1u;
+    }
+
+    return (event);
+}
+
+
+
+struct nevent * nevent_create(
+    struct nmem *               mem,
+    size_t                      size,
+    uint16_t                    id)
+{
+    ncore_lock                  sys_lock;
+    struct nevent *             event;
+
+    ncore_lock_enter(&sys_lock);
+    event = nevent_create_i(mem, size, id);
+    ncore_lock_exit(&sys_lock);
+
+    return (event);
+}
+
+
+
+void nevent_release_i(
+    struct nevent *             event)
+{
+    NREQUIRE(NAPI_POINTER, event != NULL);
+
+    if (event->mem != NULL) {                                                   /* Static events are not counted      */
+        NREQUIRE(NAPI_USAGE, event->ref != 0u);
+
+        if (--event->ref == 0u) {
+            nmem_free_i(event->mem, event);
+        }
+    }
+}
+
+
+
+void nevent_release(
+    struct nevent *             event)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    nevent_release_i(event);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+bool nevent_post_i(
+    struct nthread *            thread,
+    struct nevent *             event)
+{
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+    NREQUIRE(NAPI_POINTER, event  != NULL);
+
+    if (!nevent_mailbox_push_i(thread, event)) {
+
+        return (false);
+    }
+    nsched_thread_insert_i(thread);                                             /* One readiness for each event       */
+
+    return (true);
+}
+
+
+
+bool nevent_post(
+    struct nthread *            thread,
+    struct nevent *             event)
+{
+    ncore_lock                  sys_lock;
+    bool                        retval;
+
+    ncore_lock_enter(&sys_lock);
+    retval = nevent_post_i(thread, event);
+    ncore_lock_exit(&sys_lock);
+
+    return (retval);
+}
+
+
+
+struct nevent * nevent_fetch_i(
+    struct nthread *            thread)
+{
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+    if (thread->mailbox_count == 0u) {
+
+        return (NULL);
+    }
+    nsched_thread_remove_i(thread);
+
+    return (mailbox_pop(thread));
+}
+
+
+
+struct nevent * nevent_fetch(
+    struct nthread *            thread)
+{
+    ncore_lock                  sys_lock;
+    struct nevent *             event;
+
+    ncore_lock_enter(&sys_lock);
+    event = nevent_fetch_i(thread);
+    ncore_lock_exit(&sys_lock);
+
+    return (event);
+}
+
+#endif /* (CONFIG_SCHED_EVENT == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of event.c
+ ******************************************************************************/
@@ -0,0 +1,150 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Dispatcher idle hook for Linux hosts implementation
+ * @addtogroup  sched_host_idle
+ *********************************************************************//** @{ */
+/**@defgroup    sched_host_idle_impl Implementation
+ * @brief       Host idle hook implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/config.h"
+#include "shared/debug.h"
+#include "misc/timer.h"
+#include "sched/sched.h"
+#include "sched/host_idle.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Host Idle", "Nenad Radulovic");
+
+static int                      g_idle_fd = -1;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+/**@brief       Convert ticks to poll timeout in milliseconds, rounding up
+ */
+static int ticks_to_timeout(
+    ncore_time_tick             ticks)
+{
+    uint64_t                    timeout_ms;
+
+    if (ticks == NCORE_TIME_TICK_MAX) {
+
+        return (-1);                                                            /* No timer is running, wait forever  */
+    }
+    timeout_ms = ((uint64_t)ticks * 1000u + CONFIG_CORE_TIMER_EVENT_FREQ - 1u) /
+        CONFIG_CORE_TIMER_EVENT_FREQ;
+
+    if (timeout_ms > INT32_MAX) {
+        timeout_ms = INT32_MAX;
+    }
+
+    return ((int)timeout_ms);
+}
+
+
+
+static void host_idle(
+    void *                      arg)
+{
+    struct pollfd               fds;
+    ncore_lock                  sys_lock;
+    ncore_time_tick             ticks;
+    uint64_t                    count;
+
+    (void)arg;
+
+    ncore_lock_enter(&sys_lock);
+    ticks = ntimer_next_expiry_i();
+    ncore_lock_exit(&sys_lock);
+
+    fds.fd      = g_idle_fd;
+    fds.events  = POLLIN;
+    fds.revents = 0;
+
+    if ((poll(&fds, 1, ticks_to_timeout(ticks)) == 1) &&
+        ((fds.revents & POLLIN) != 0)) {
+        (void)read(g_idle_fd, &count, sizeof(count));                           /* Consume all pending wakes          */
+    }
+}
+
+
+
+static void host_wake(
+    void *                      arg)
+{
+    uint64_t                    count = 1u;
+
+    (void)arg;
+    (void)write(g_idle_fd, &count, sizeof(count));
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+bool nsched_host_idle_init(void)
+{
+    NREQUIRE(NAPI_USAGE, g_idle_fd == -1);
+
+    g_idle_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (g_idle_fd == -1) {
+
+        return (false);
+    }
+    nsched_set_idle(host_idle, host_wake, NULL);
+
+    return (true);
+}
+
+
+
+void nsched_host_idle_term(void)
+{
+    NREQUIRE(NAPI_USAGE, g_idle_fd != -1);
+
+    nsched_set_idle(NULL, NULL, NULL);
+    (void)close(g_idle_fd);
+    g_idle_fd = -1;
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of host_idle.c
+ ******************************************************************************/
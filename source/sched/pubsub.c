@@ -0,0 +1,155 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Publish/subscribe bus implementation
+ * @addtogroup  sched_pubsub
+ *********************************************************************//** @{ */
+/**@defgroup    sched_pubsub_impl Implementation
+ * @brief       Publish/subscribe bus implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include "port/core.h"
+#include "port/compiler.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "sched/pubsub.h"
+
+#if (CONFIG_SCHED_EVENT == 1)
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define NODE_TO_SUBSCRIPTION(node_ptr)                                          \
+    CONTAINER_OF(node_ptr, struct nsubscription, node)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Publish/Subscribe", "Nenad Radulovic");
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+void ntopic_init(
+    struct ntopic *             topic)
+{
+    NREQUIRE(NAPI_POINTER, topic != NULL);
+
+    ndlist_init(&topic->subscribers);
+}
+
+
+
+void ntopic_subscribe(
+    struct ntopic *             topic,
+    struct nsubscription *      subscription,
+    struct nthread *            thread)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, topic != NULL);
+    NREQUIRE(NAPI_POINTER, subscription != NULL);
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+    subscription->thread = thread;
+    ncore_lock_enter(&sys_lock);
+    ndlist_add_before(&topic->subscribers, &subscription->node);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void ntopic_unsubscribe(
+    struct nsubscription *      subscription)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, subscription != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    ndlist_remove(&subscription->node);
+    ndlist_init(&subscription->node);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+size_t ntopic_publish_i(
+    struct ntopic *             topic,
+    struct nevent *             event)
+{
+    size_t                      delivered;
+    struct ndlist *             current;
+
+    NREQUIRE(NAPI_POINTER, topic != NULL);
+    NREQUIRE(NAPI_POINTER, event != NULL);
+
+    delivered = 0u;
+
+    for (current  = ndlist_next(&topic->subscribers);
+         current != &topic->subscribers;
+         current  = ndlist_next(current)) {
+        struct nthread *        thread;
+
+        thread = NODE_TO_SUBSCRIPTION(current)->thread;
+
+        if (!nevent_mailbox_push_i(thread, event)) {
+            continue;                                                           /* Full mailbox misses this event     */
+        }
+        if (event->mem != NULL) {
+            NREQUIRE(NAPI_USAGE, event->ref != UINT16_MAX);
+            event->ref++;
+        }
+        delivered++;
+        nsched_thread_insert_i(thread);
+    }
+    nevent_release_i(event);                                                    /* Drop the reference of publisher    */
+
+    return (delivered);
+}
+
+
+
+size_t ntopic_publish(
+    struct ntopic *             topic,
+    struct nevent *             event)
+{
+    ncore_lock                  sys_lock;
+    size_t                      delivered;
+
+    ncore_lock_enter(&sys_lock);
+    delivered = ntopic_publish_i(topic, event);
+    ncore_lock_exit(&sys_lock);
+
+    return (delivered);
+}
+
+#endif /* (CONFIG_SCHED_EVENT == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of pubsub.c
+ ******************************************************************************/
@@ -0,0 +1,268 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Thread registry implementation
+ * @addtogroup  sched_registry
+ *********************************************************************//** @{ */
+/**@defgroup    sched_registry_impl Implementation
+ * @brief       Thread registry implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <string.h>
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "sched/sched.h"
+#include "sched/registry.h"
+
+#if (CONFIG_REGISTRY == 1)
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define FNV_OFFSET_BASIS                0x811c9dc5u
+#define FNV_PRIME                       0x01000193u
+
+#define BUCKET_MASK                     (CONFIG_REGISTRY_BUCKETS - 1u)
+
+#define NODE_TO_THREAD(node_ptr)                                                \
+    CONTAINER_OF(node_ptr, struct nthread, registry_node)
+
+#define HASH_NODE_TO_THREAD(node_ptr)                                           \
+    CONTAINER_OF(node_ptr, struct nthread, registry_hash_node)
+
+#define NODE_TO_ITER(node_ptr)                                                  \
+    CONTAINER_OF(node_ptr, struct nregistry_iter, node)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+struct registry
+{
+    struct ndlist               threads;        /**<@brief All threads        */
+    struct ndlist               iters;          /**<@brief Active iterators   */
+    struct ndlist               bucket[CONFIG_REGISTRY_BUCKETS];
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Thread Registry", "Nenad Radulovic");
+
+static struct registry          g_registry;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+/**@brief       FNV-1a hash of a name limited to CONFIG_REGISTRY_NAME_SIZE
+ */
+static uint32_t name_hash(
+    const char *                name)
+{
+    uint32_t                    hash;
+    uint_fast16_t               count;
+
+    hash = FNV_OFFSET_BASIS;
+
+    for (count = 0u; (count < CONFIG_REGISTRY_NAME_SIZE) && (name[count] != '\0');
+         count++) {
+        hash ^= (uint8_t)name[count];
+        hash *= FNV_PRIME;
+    }
+
+    return (hash);
+}
+
+
+
+/**@brief       Returns the thread after @c thread or NULL at the end
+ */
+static struct nthread * thread_next(
+    const struct nthread *      thread)
+{
+    struct ndlist *             next;
+
+    next = ndlist_next(&thread->registry_node);
+
+    if (next == &g_registry.threads) {
+
+        return (NULL);
+    }
+
+    return (NODE_TO_THREAD(next));
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+
+
+void nregistry_init(void)
+{
+    struct registry *           registry = &g_registry;
+    uint_fast16_t               bucket;
+
+    ndlist_init(&registry->threads);
+    ndlist_init(&registry->iters);
+
+    for (bucket = 0u; bucket < CONFIG_REGISTRY_BUCKETS; bucket++) {
+        ndlist_init(&registry->bucket[bucket]);
+    }
+}
+
+
+
+void nregistry_link_i(
+    struct nthread *            thread)
+{
+    struct registry *           registry = &g_registry;
+
+    thread->registry_hash = name_hash(thread->name);
+    ndlist_add_before(&registry->threads, &thread->registry_node);
+    ndlist_add_before(&registry->bucket[thread->registry_hash & BUCKET_MASK],
+        &thread->registry_hash_node);
+}
+
+
+
+void nregistry_unlink_i(
+    struct nthread *            thread)
+{
+    struct registry *           registry = &g_registry;
+    struct ndlist *             current;
+
+    for (current = ndlist_next(&registry->iters); current != &registry->iters;
+         current = ndlist_next(current)) {
+        struct nregistry_iter * iter = NODE_TO_ITER(current);
+
+        if (iter->next == thread) {                                             /* Step iterator over unlinked thread */
+            iter->next = thread_next(thread);
+        }
+    }
+    ndlist_remove(&thread->registry_node);
+    ndlist_init(&thread->registry_node);
+    ndlist_remove(&thread->registry_hash_node);
+    ndlist_init(&thread->registry_hash_node);
+}
+
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+struct nthread * nregistry_find(
+    const char *                name)
+{
+    struct registry *           registry = &g_registry;
+    struct ndlist *             bucket;
+    struct ndlist *             current;
+    struct nthread *            found;
+    uint32_t                    hash;
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, name != NULL);
+
+    hash   = name_hash(name);
+    bucket = &registry->bucket[hash & BUCKET_MASK];
+    found  = NULL;
+    ncore_lock_enter(&sys_lock);
+
+    for (current = ndlist_next(bucket); current != bucket;
+         current = ndlist_next(current)) {
+        struct nthread *        thread = HASH_NODE_TO_THREAD(current);
+
+        if ((thread->registry_hash == hash) &&
+            (strncmp(thread->name, name, CONFIG_REGISTRY_NAME_SIZE) == 0)) {
+            found = thread;
+            break;
+        }
+    }
+    ncore_lock_exit(&sys_lock);
+
+    return (found);
+}
+
+
+
+void nregistry_iter_begin(
+    struct nregistry_iter *     iter)
+{
+    struct registry *           registry = &g_registry;
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, iter != NULL);
+
+    ncore_lock_enter(&sys_lock);
+
+    if (ndlist_is_empty(&registry->threads)) {
+        iter->next = NULL;
+        ndlist_init(&iter->node);
+    } else {
+        iter->next = NODE_TO_THREAD(ndlist_next(&registry->threads));
+        ndlist_add_before(&registry->iters, &iter->node);
+    }
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+struct nthread * nregistry_iter_next(
+    struct nregistry_iter *     iter)
+{
+    struct nthread *            thread;
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, iter != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    thread = iter->next;
+
+    if (thread != NULL) {
+        iter->next = thread_next(thread);
+    } else {
+        ndlist_remove(&iter->node);
+        ndlist_init(&iter->node);
+    }
+    ncore_lock_exit(&sys_lock);
+
+    return (thread);
+}
+
+
+
+void nregistry_iter_end(
+    struct nregistry_iter *     iter)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, iter != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    ndlist_remove(&iter->node);
+    ndlist_init(&iter->node);
+    iter->next = NULL;
+    ncore_lock_exit(&sys_lock);
+}
+
+#endif /* (CONFIG_REGISTRY == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of registry.c
+ ******************************************************************************/
@@ -35,14 +35,34 @@
 #include "port/core.h"
 #include "shared/component.h"
 #include "shared/bitop.h"
+#include "shared/debug.h"
+#include "misc/trace.h"
+#include "sched/event.h"
 #include "sched/prio_queue.h"
+#include "sched/registry.h"
 #include "sched/sched.h"
+#include "sched/sync.h"
+#include "sched/watchdog.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
 
 #define NODE_TO_THREAD(node_ptr)                                                \
     CONTAINER_OF(node_ptr, struct nthread, node)
 
+#if (CONFIG_SCHED_EDF == 1)
+#define EDF_SLOT(ctx)                   (&(ctx)->edf_slot)
+#else
+#define EDF_SLOT(ctx)                   (NULL)
+#endif
+
+#define EDF_NODE_TO_THREAD(node_ptr)                                            \
+    CONTAINER_OF(node_ptr, struct nthread, edf_node)
+
+/**@brief       Returns true if deadline @c a is before deadline @c b
+ */
+#define EDF_IS_BEFORE(a, b)                                                     \
+    ((ncore_time_tick)((a) - (b)) > (NCORE_TIME_TICK_MAX / 2u))
+
 /*======================================================  LOCAL DATA TYPES  ==*/
 
 /**@brief       Scheduler context structure
@@ -52,15 +72,330 @@ struct sched_ctx
 {
     struct nbias_list *         current;    /**<@brief The current thread     */
     struct nprio_queue          run_queue;  /**<@brief Run queue of threads   */
+#if (CONFIG_SCHED_STATS == 1)
+    nstamp                      run_stamp;  /**<@brief Current started at     */
+#endif
+#if (CONFIG_SCHED_EDF == 1)
+    struct ndlist               edf_queue;  /**<@brief Deadline sorted queue  */
+    struct nbias_list           edf_slot;   /**<@brief EDF class in run queue */
+#endif
+    void                     (* idle)(void *);  /**<@brief Idle hook          */
+    void                     (* wake)(void *);  /**<@brief Wake hook          */
+    void *                      idle_arg;   /**<@brief Idle hooks argument    */
+    volatile bool               should_run; /**<@brief Dispatcher is running  */
+    bool                        is_idle;    /**<@brief Idle hook is running   */
+#if (CONFIG_SCHED_AGING == 1)
+    uint_fast8_t                aging_cursor;   /**<@brief Next bucket to age */
+    uint_fast16_t               aging_count;    /**<@brief Dispatches counter */
+#endif
 };
 
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
 /*=======================================================  LOCAL VARIABLES  ==*/
 
+static const NCOMPONENT_DEFINE("Scheduler", "Nenad Radulovic");
+
 static struct sched_ctx         g_sched_ctx;
 
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+#if (CONFIG_SCHED_EDF == 1)
+PORT_C_INLINE
+bool thread_is_edf(
+    const struct nthread *      thread)
+{
+#if (CONFIG_SCHED_AGING == 1)
+    return (thread->base_priority == CONFIG_SCHED_EDF_PRIORITY);
+#else
+    return (nbias_list_get_bias(&thread->node) == CONFIG_SCHED_EDF_PRIORITY);
+#endif
+}
+
+
+
+/**@brief       Insert thread into EDF queue
+ * @details     Threads with equal deadlines are kept in FIFO order.
+ */
+static void edf_insert(
+    struct sched_ctx *          ctx,
+    struct nthread *            thread)
+{
+    struct ndlist *             current;
+
+    current = ndlist_prev(&ctx->edf_queue);
+
+    while ((current != &ctx->edf_queue) &&
+           EDF_IS_BEFORE(thread->deadline, EDF_NODE_TO_THREAD(current)->deadline)) {
+        current = ndlist_prev(current);
+    }
+    ndlist_add_after(current, &thread->edf_node);
+}
+
+
+
+PORT_C_INLINE
+void edf_remove(
+    struct nthread *            thread)
+{
+    ndlist_remove(&thread->edf_node);
+    ndlist_init(&thread->edf_node);
+}
+#endif
+
+
+
+#if (CONFIG_SCHED_AGING == 1)
+/**@brief       Move a thread which is in run queue to another priority level
+ */
+static void aging_move(
+    struct sched_ctx *          ctx,
+    struct nthread *            thread,
+    uint_fast8_t                priority)
+{
+    nprio_queue_remove(&ctx->run_queue, &thread->node);
+    nbias_list_init(&thread->node, priority);
+    nprio_queue_insert(&ctx->run_queue, &thread->node);
+}
+
+
+
+/**@brief       Boost the next waiting thread to the highest ready priority
+ * @details     Buckets below the highest ready one are visited round-robin,
+ *              going down, so the scan is bounded by the number of buckets.
+ */
+static void aging_step(
+    struct sched_ctx *          ctx)
+{
+    uint_fast8_t                priority;
+    uint_fast8_t                top;
+    uint_fast8_t                count;
+
+    priority = nbias_list_get_bias(nprio_queue_peek(&ctx->run_queue));
+    top      = priority >> NPRIO_ARRAY_BUCKET_BITS;
+
+    for (count = 0u; count < CONFIG_PRIORITY_BUCKETS; count++) {
+        uint_fast8_t            bucket;
+        struct nbias_list *     candidate;
+
+        bucket = ctx->aging_cursor;
+        ctx->aging_cursor = (bucket != 0u) ?
+            (uint_fast8_t)(bucket - 1u) : (uint_fast8_t)(CONFIG_PRIORITY_BUCKETS - 1u);
+
+        if (bucket >= top) {
+            continue;
+        }
+        candidate = nprio_queue_peek_bucket(&ctx->run_queue, bucket);
+
+        if (candidate == NULL) {
+            continue;
+        }
+#if (CONFIG_SCHED_EDF == 1)
+        if (candidate == &ctx->edf_slot) {
+            continue;
+        }
+#endif
+        aging_move(ctx, NODE_TO_THREAD(candidate), priority);
+
+        return;
+    }
+}
+#endif
+
+
+
+#if (CONFIG_SCHED_WEIGHTED == 1)
+/**@brief       Consume one dispatch credit of the head node of a level
+ * @return      Returns true when the node has used its credit and the level
+ *              must be rotated.
+ */
+static bool weighted_is_exhausted(
+    struct sched_ctx *          ctx,
+    struct nbias_list *         node)
+{
+    struct nthread *            thread;
+
+#if (CONFIG_SCHED_EDF == 1)
+    if (node == &ctx->edf_slot) {
+
+        return (true);
+    }
+#else
+    (void)ctx;
+#endif
+    thread = NODE_TO_THREAD(node);
+
+    if (thread->credit > 1u) {
+        thread->credit--;
+
+        return (false);
+    }
+    thread->credit = thread->weight;
+
+    return (true);
+}
+#endif
+
+
+
+/**@brief       Advance the run queue after @c node was picked to run
+ */
+static void queue_advance(
+    struct sched_ctx *          ctx,
+    struct nbias_list *         node)
+{
+#if (CONFIG_SCHED_AGING == 1)
+    if ((node != EDF_SLOT(ctx)) &&
+        (nbias_list_get_bias(node) != NODE_TO_THREAD(node)->base_priority)) {
+        aging_move(ctx, NODE_TO_THREAD(node),                                   /* Boosted thread got its turn, drop  */
+            NODE_TO_THREAD(node)->base_priority);                               /* it back to its own priority.       */
+
+        return;
+    }
+#endif
+#if (CONFIG_SCHED_WEIGHTED == 1)
+    if (!weighted_is_exhausted(ctx, node)) {
+
+        return;
+    }
+#endif
+    nprio_queue_rotate(&ctx->run_queue, node);
+}
+
+
+
+#if (CONFIG_SCHED_STATS == 1)
+/**@brief       Account the run which has just finished and the one to start
+ */
+static void stats_dispatch(
+    struct sched_ctx *          ctx,
+    struct nthread *            next)
+{
+    nstamp                      now;
+    nstamp                      delta;
+
+    now = nstamp_get();
+
+    if (ctx->current != NULL) {
+        struct nthread *        prev = NODE_TO_THREAD(ctx->current);
+
+        delta = nstamp_delta(ctx->run_stamp, now);
+        prev->stats.run_total += delta;
+
+        if (prev->stats.run_max < delta) {
+            prev->stats.run_max = delta;
+        }
+        prev->ready_stamp = now;                                                /* If still ready it waits from now on*/
+    }
+
+    if (next != NULL) {
+        delta = nstamp_delta(next->ready_stamp, now);
+        next->stats.dispatches++;
+        next->stats.latency_hist[
+            nstamp_log2_bucket(delta, CONFIG_SCHED_STATS_BUCKETS)]++;
+
+        if (next->stats.latency_max < delta) {
+            next->stats.latency_max = delta;
+        }
+        ctx->run_stamp = now;
+    }
+}
+#endif
+
+
+
+static void queue_insert(
+    struct sched_ctx *          ctx,
+    struct nthread *            thread)
+{
+#if (CONFIG_SCHED_EDF == 1)
+    if (thread_is_edf(thread)) {
+
+        if (ndlist_is_empty(&ctx->edf_queue)) {                                 /* EDF class enters the run queue with*/
+            nprio_queue_insert(&ctx->run_queue, &ctx->edf_slot);                /* its first ready thread.            */
+        }
+        edf_insert(ctx, thread);
+
+        return;
+    }
+#endif
+    nprio_queue_insert(&ctx->run_queue, &thread->node);
+}
+
+
+
+static void queue_remove(
+    struct sched_ctx *          ctx,
+    struct nthread *            thread)
+{
+#if (CONFIG_SCHED_EDF == 1)
+    if (thread_is_edf(thread)) {
+        edf_remove(thread);
+
+        if (ndlist_is_empty(&ctx->edf_queue)) {                                 /* EDF class leaves the run queue with*/
+            nprio_queue_remove(&ctx->run_queue, &ctx->edf_slot);                /* its last ready thread.             */
+        }
+
+        return;
+    }
+#endif
+    nprio_queue_remove(&ctx->run_queue, &thread->node);
+#if (CONFIG_SCHED_AGING == 1)
+    if (nbias_list_get_bias(&thread->node) != thread->base_priority) {         /* Leaving the queue ends the boost   */
+        nbias_list_init(&thread->node, thread->base_priority);
+    }
+#endif
+}
+
+/**@brief       Initialize thread members, except registry linkage
+ */
+static void thread_init(
+    struct nthread *            thread,
+    const struct nthread_define * define)
+{
+    nbias_list_init(&thread->node, define->priority);
+    thread->ref   = 0;
+    thread->entry = define->entry;
+    thread->arg   = define->arg;
+#if (CONFIG_SCHED_AGING == 1)
+    thread->base_priority = define->priority;
+#endif
+#if (CONFIG_SCHED_WATCHDOG == 1)
+    thread->budget = define->budget;
+#endif
+#if (CONFIG_SCHED_WEIGHTED == 1)
+    thread->weight = (define->weight != 0u) ? define->weight : 1u;
+    thread->credit = thread->weight;
+#endif
+#if (CONFIG_SCHED_STATS == 1)
+    memset(&thread->stats, 0, sizeof(thread->stats));
+    thread->ready_stamp = 0u;
+#endif
+#if (CONFIG_SCHED_EDF == 1)
+    ndlist_init(&thread->edf_node);
+    thread->deadline = 0u;
+#endif
+#if (CONFIG_SCHED_SYNC == 1)
+    thread->parked_ref = 0u;
+    thread->is_parked  = false;
+    nsync_thread_init(thread);
+#endif
+#if (CONFIG_SCHED_EVENT == 1)
+    thread->mailbox_head  = 0u;
+    thread->mailbox_count = 0u;
+#endif
+
+#if (CONFIG_REGISTRY == 1)
+    memset(thread->name, 0, sizeof(thread->name));
+
+    if (define->name) {
+        strncpy(thread->name, define->name, sizeof(thread->name));
+    }
+    ndlist_init(&thread->registry_node);
+    ndlist_init(&thread->registry_hash_node);
+#endif
+}
+
 /*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
 /*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
 
@@ -68,8 +403,24 @@ void nsched_init(void)
 {
     struct sched_ctx *          ctx = &g_sched_ctx;
 
-    ctx->current = NULL;
+    ctx->current    = NULL;
+    ctx->idle       = NULL;
+    ctx->wake       = NULL;
+    ctx->idle_arg   = NULL;
+    ctx->should_run = false;
+    ctx->is_idle    = false;
+#if (CONFIG_SCHED_AGING == 1)
+    ctx->aging_cursor = CONFIG_PRIORITY_BUCKETS - 1u;
+    ctx->aging_count  = 0u;
+#endif
     nprio_queue_init(&ctx->run_queue);     /* Initialize run_queue structure. */
+#if (CONFIG_REGISTRY == 1)
+    nregistry_init();
+#endif
+#if (CONFIG_SCHED_EDF == 1)
+    ndlist_init(&ctx->edf_queue);
+    nbias_list_init(&ctx->edf_slot, CONFIG_SCHED_EDF_PRIORITY);
+#endif
 }
 
 
@@ -87,17 +438,40 @@ void nsched_thread_init(
     struct nthread *            thread,
     const struct nthread_define * define)
 {
-    nbias_list_init(&thread->node, define->priority);
-    thread->ref = 0;
+#if (CONFIG_REGISTRY == 1)
+    ncore_lock                  sys_lock;
+#endif
 
+    thread_init(thread, define);
 #if (CONFIG_REGISTRY == 1)
-    memset(thread->name, 0, sizeof(thread->name));
+    ncore_lock_enter(&sys_lock);
+    nregistry_link_i(thread);
+    ncore_lock_exit(&sys_lock);
+#endif
+}
 
-    if (define->name) {
-        strncpy(thread->name, define->name, sizeof(thread->name));
+
+
+void nsched_thread_table_start(
+    const struct nthread_table * table)
+{
+    ncore_lock                  sys_lock;
+    size_t                      count;
+
+    NREQUIRE(NAPI_POINTER, table != NULL);
+
+    for (count = 0u; count < table->count; count++) {
+        thread_init(&table->thread[count], &table->define[count]);
     }
-    ndlist_init(&thread->registry_node);
+    ncore_lock_enter(&sys_lock);
+
+    for (count = 0u; count < table->count; count++) {
+#if (CONFIG_REGISTRY == 1)
+        nregistry_link_i(&table->thread[count]);
 #endif
+        nsched_thread_insert_i(&table->thread[count]);
+    }
+    ncore_lock_exit(&sys_lock);
 }
 
 
@@ -111,8 +485,24 @@ void nsched_thread_term(struct nthread * thread)
 
     if (thread->ref != 0u) {
         thread->ref =  0u;
-        nprio_queue_remove(&ctx->run_queue, &thread->node);
+        NTRACE(NTRACE_THREAD_REMOVE, thread, nbias_list_get_bias(&thread->node));
+        queue_remove(ctx, thread);
     }
+
+    if (ctx->current == &thread->node) {
+        ctx->current = NULL;
+    }
+#if (CONFIG_SCHED_SYNC == 1)
+    thread->parked_ref = 0u;
+    thread->is_parked  = false;
+    nsync_thread_term_i(thread);
+#endif
+#if (CONFIG_SCHED_EVENT == 1)
+    nevent_mailbox_term_i(thread);
+#endif
+#if (CONFIG_REGISTRY == 1)
+    nregistry_unlink_i(thread);
+#endif
     nbias_list_term(&thread->node);
     ncore_lock_exit(&sys_lock);
 }
@@ -121,12 +511,30 @@ void nsched_thread_term(struct nthread * thread)
 
 void nsched_thread_insert_i(struct nthread * thread)
 {
+#if (CONFIG_SCHED_SYNC == 1)
+    if (thread->is_parked) {                                                    /* Keep it until the thread is unparked*/
+        ncore_sat_increment(&thread->parked_ref);
+
+        return;
+    }
+#endif
     ncore_sat_increment(&thread->ref);
 
     if (thread->ref == 1u) {
         struct sched_ctx *      ctx = &g_sched_ctx;
 
-        nprio_queue_insert(&ctx->run_queue, &thread->node);
+#if (CONFIG_SCHED_STATS == 1)
+        thread->ready_stamp = nstamp_get();
+#endif
+
+        if (ctx->is_idle && nprio_queue_is_empty(&ctx->run_queue)) {           /* Wake only a sleeping dispatcher    */
+            ctx->wake(ctx->idle_arg);
+        }
+        NTRACE(NTRACE_THREAD_INSERT, thread, nbias_list_get_bias(&thread->node));
+#if (CONFIG_SCHED_WEIGHTED == 1)
+        thread->credit = thread->weight;                                        /* Deficit is reset on each arrival   */
+#endif
+        queue_insert(ctx, thread);
     }
 }
 
@@ -134,10 +542,18 @@ void nsched_thread_insert_i(struct nthread * thread)
 
 void nsched_thread_remove_i(struct nthread * thread)
 {
+#if (CONFIG_SCHED_SYNC == 1)
+    if (thread->is_parked) {
+        ncore_sat_decrement(&thread->parked_ref);
+
+        return;
+    }
+#endif
     if (thread->ref == 1u) {
         struct sched_ctx *      ctx = &g_sched_ctx;
 
-        nprio_queue_remove(&ctx->run_queue, &thread->node);
+        NTRACE(NTRACE_THREAD_REMOVE, thread, nbias_list_get_bias(&thread->node));
+        queue_remove(ctx, thread);
     }
     ncore_sat_decrement(&thread->ref);
 }
@@ -150,13 +566,34 @@ struct nthread * nsched_thread_fetch_i(void)
     struct nbias_list *         new_node;
 
     if (!nprio_queue_is_empty(&ctx->run_queue)) {
+#if (CONFIG_SCHED_AGING == 1) && (CONFIG_SCHED_AGING_PERIOD != 0u)
+        if (++ctx->aging_count >= CONFIG_SCHED_AGING_PERIOD) {
+            ctx->aging_count = 0u;
+            aging_step(ctx);
+        }
+#endif
         new_node = nprio_queue_peek(&ctx->run_queue);
-        nprio_queue_rotate(&ctx->run_queue, new_node);
+        queue_advance(ctx, new_node);
+#if (CONFIG_SCHED_EDF == 1)
+        if (new_node == &ctx->edf_slot) {                                       /* EDF class won, take the thread with*/
+            new_node = &EDF_NODE_TO_THREAD(                                     /* the earliest deadline.             */
+                ndlist_next(&ctx->edf_queue))->node;
+        }
+#endif
+#if (CONFIG_SCHED_STATS == 1)
+        stats_dispatch(ctx, NODE_TO_THREAD(new_node));
+#endif
         ctx->current = new_node;
+        NTRACE(NTRACE_THREAD_DISPATCH, NODE_TO_THREAD(new_node),
+            nbias_list_get_bias(new_node));
 
         return (NODE_TO_THREAD(new_node));
     } else {
+#if (CONFIG_SCHED_STATS == 1)
+        stats_dispatch(ctx, NULL);
+#endif
         ctx->current = NULL;
+        NTRACE(NTRACE_SCHED_IDLE, NULL, 0u);
 
         return (NULL);
     }
@@ -171,6 +608,234 @@ struct nthread * nsched_get_current(void)
     return (NODE_TO_THREAD(ctx->current));
 }
 
+
+
+
+void nsched_run(void)
+{
+    struct sched_ctx *          ctx = &g_sched_ctx;
+    ncore_lock                  sys_lock;
+
+    ctx->should_run = true;
+    ncore_lock_enter(&sys_lock);
+
+    while (ctx->should_run) {
+        struct nthread *        thread;
+#if (CONFIG_SCHED_WATCHDOG == 1)
+        bool                    is_watched;
+#endif
+
+        thread = nsched_thread_fetch_i();
+#if (CONFIG_SCHED_WATCHDOG == 1)
+        is_watched = (thread != NULL) && nwatchdog_arm_i(thread);
+#endif
+        ctx->is_idle = (thread == NULL) && (ctx->idle != NULL) &&
+            (ctx->wake != NULL);                                                /* Inserts wake the idle hook only now*/
+        ncore_lock_exit(&sys_lock);
+
+        if (thread != NULL) {
+            NREQUIRE(NAPI_POINTER, thread->entry != NULL);
+            thread->entry(thread->arg);
+        } else if (ctx->idle != NULL) {
+            ctx->idle(ctx->idle_arg);
+        }
+        ncore_lock_enter(&sys_lock);
+        ctx->is_idle = false;
+#if (CONFIG_SCHED_WATCHDOG == 1)
+        if (is_watched && nwatchdog_disarm_i(thread)) {
+            ncore_lock_exit(&sys_lock);
+            nwatchdog_report(thread);                                           /* Policy runs without the lock       */
+            ncore_lock_enter(&sys_lock);
+        }
+#endif
+    }
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void nsched_stop(void)
+{
+    struct sched_ctx *          ctx = &g_sched_ctx;
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    ctx->should_run = false;
+
+    if (ctx->wake != NULL) {
+        ctx->wake(ctx->idle_arg);
+    }
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void nsched_set_idle(
+    void                     (* idle)(void *),
+    void                     (* wake)(void *),
+    void *                      arg)
+{
+    struct sched_ctx *          ctx = &g_sched_ctx;
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    ctx->idle     = idle;
+    ctx->wake     = wake;
+    ctx->idle_arg = arg;
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+#if (CONFIG_SCHED_EDF == 1)
+void nsched_thread_set_deadline_i(
+    struct nthread *            thread,
+    ncore_time_tick             deadline)
+{
+    NREQUIRE(NAPI_USAGE, thread_is_edf(thread));
+
+    thread->deadline = deadline;
+
+    if (thread->ref != 0u) {                                                    /* Re-sort if it is already queued    */
+        struct sched_ctx *      ctx = &g_sched_ctx;
+
+        edf_remove(thread);
+        edf_insert(ctx, thread);
+    }
+}
+#endif
+
+
+
+#if (CONFIG_SCHED_AGING == 1)
+void nsched_age_i(void)
+{
+    struct sched_ctx *          ctx = &g_sched_ctx;
+
+    if (!nprio_queue_is_empty(&ctx->run_queue)) {
+        aging_step(ctx);
+    }
+}
+#endif
+
+
+
+#if (CONFIG_SCHED_SYNC == 1)
+void nsched_thread_park_i(
+    struct nthread *            thread)
+{
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+    NREQUIRE(NAPI_USAGE,   !thread->is_parked);
+
+    thread->parked_ref = thread->ref;
+
+    if (thread->ref != 0u) {
+        thread->ref = 1u;
+        nsched_thread_remove_i(thread);
+    }
+    thread->is_parked = true;
+}
+
+
+
+void nsched_thread_unpark_i(
+    struct nthread *            thread)
+{
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+    NREQUIRE(NAPI_USAGE,   thread->is_parked);
+
+    thread->is_parked = false;
+
+    if (thread->parked_ref != 0u) {
+        nsched_thread_insert_i(thread);
+        thread->ref = thread->parked_ref;
+    }
+}
+#endif
+
+
+
+void nsched_thread_set_priority_i(
+    struct nthread *            thread,
+    uint_fast8_t                priority)
+{
+    struct sched_ctx *          ctx = &g_sched_ctx;
+
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+    NREQUIRE(NAPI_RANGE,   priority <= NTHREAD_PRIORITY_MAX);
+
+    if (thread->ref != 0u) {
+        queue_remove(ctx, thread);
+    }
+#if (CONFIG_SCHED_AGING == 1)
+    thread->base_priority = priority;
+#endif
+    nbias_list_init(&thread->node, priority);
+
+    if (thread->ref != 0u) {
+        queue_insert(ctx, thread);
+    }
+}
+
+
+
+uint_fast8_t nsched_thread_get_priority_i(
+    const struct nthread *      thread)
+{
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+#if (CONFIG_SCHED_AGING == 1)
+    return (thread->base_priority);
+#else
+    return (nbias_list_get_bias(&thread->node));
+#endif
+}
+
+
+
+#if (CONFIG_SCHED_WEIGHTED == 1)
+void nsched_thread_set_weight_i(
+    struct nthread *            thread,
+    uint_fast8_t                weight)
+{
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+    thread->weight = (weight != 0u) ? weight : 1u;
+}
+#endif
+
+
+
+#if (CONFIG_SCHED_STATS == 1)
+void nsched_thread_stats(
+    const struct nthread *      thread,
+    struct nthread_stats *      stats)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+    NREQUIRE(NAPI_POINTER, stats  != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    *stats = thread->stats;
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void nsched_thread_stats_clear(
+    struct nthread *            thread)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    memset(&thread->stats, 0, sizeof(thread->stats));
+    ncore_lock_exit(&sys_lock);
+}
+#endif
+
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//** @} *//*********************************************
  * END of sched.c
@@ -0,0 +1,838 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Synchronization objects implementation
+ * @addtogroup  sched_sync
+ *********************************************************************//** @{ */
+/**@defgroup    sched_sync_impl Implementation
+ * @brief       Synchronization objects implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include "port/core.h"
+#include "port/compiler.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "misc/timer.h"
+#include "sched/sync.h"
+
+#if (CONFIG_SCHED_SYNC == 1)
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define WAIT_NODE_TO_THREAD(node_ptr)                                           \
+    CONTAINER_OF(node_ptr, struct nthread, wait_node)
+
+#define HELD_NODE_TO_MUTEX(node_ptr)                                            \
+    CONTAINER_OF(node_ptr, struct nmutex, held_node)
+
+#define HELD_NODE_TO_RESOURCE(node_ptr)                                         \
+    CONTAINER_OF(node_ptr, struct nresource, held_node)
+
+/**@brief       Kind of object a thread waits on
+ * @{ */
+#define WAIT_SEM                        0u
+#define WAIT_MUTEX                      1u
+#define WAIT_RESOURCE                   2u
+#define WAIT_FLAGS                      3u
+/** @} */
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+
+static void resource_update(
+    struct nthread *            thread);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Synchronization", "Nenad Radulovic");
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+/**@brief       Make ready a thread which was already taken off a wait queue
+ */
+static void sync_wake(
+    struct nthread *            thread,
+    uint8_t                     status)
+{
+    ntimer_cancel_i(&thread->wait_timer);
+    thread->wait_status = status;
+    nsched_thread_unpark_i(thread);
+    nsched_thread_insert_i(thread);                                             /* One for the wake                   */
+}
+
+
+
+/**@brief       Take a pending thread off its wait queue before the wait is done
+ * @details     When the thread leaves an inheritance resource, the owner may
+ *              no longer be due the priority it inherited from it.
+ */
+static void sync_unqueue(
+    struct nthread *            thread)
+{
+    nprio_queue_remove(thread->wait_queue, &thread->wait_node);
+
+    if (thread->wait_object == WAIT_RESOURCE) {
+        struct nresource *      resource;
+
+        resource = CONTAINER_OF(thread->wait_queue, struct nresource,
+            wait_queue);
+
+        if (resource->owner != NULL) {
+            resource_update(resource->owner);
+        }
+    }
+}
+
+
+
+static void sync_timeout(
+    void *                      arg)
+{
+    struct nthread *            thread = arg;
+
+    sync_unqueue(thread);
+    thread->wait_flags  = 0u;
+    thread->wait_status = NSYNC_TIMEOUT;
+    nsched_thread_unpark_i(thread);
+    nsched_thread_insert_i(thread);
+}
+
+
+
+/**@brief       Take a thread off the run queue and park it on a wait queue
+ * @details     The wait drops the readiness of the current run. The thread is
+ *              parked, so other pending insertions, like events in its
+ *              mailbox, do not dispatch it before the wait completes.
+ */
+static void sync_park(
+    struct nprio_queue *        queue,
+    struct nthread *            thread,
+    ncore_time_tick             timeout,
+    uint8_t                     object)
+{
+    nsched_thread_remove_i(thread);
+    nsched_thread_park_i(thread);
+    thread->wait_object = object;
+    nbias_list_init(&thread->wait_node, nbias_list_get_bias(&thread->node));    /* Wait at the current priority       */
+    nprio_queue_insert(queue, &thread->wait_node);
+    thread->wait_queue  = queue;
+    thread->wait_status = NSYNC_PENDING;
+
+    if (timeout != NSYNC_WAIT_FOREVER) {
+        ntimer_start_i(&thread->wait_timer, timeout, sync_timeout, thread,
+            NTIMER_ATTR_ONE_SHOT);
+    }
+}
+
+
+
+/**@brief       Return the result of a wait, consuming it when it is complete
+ */
+static int sync_collect(
+    struct nthread *            thread)
+{
+    uint8_t                     status;
+
+    status = thread->wait_status;
+
+    if (status != NSYNC_PENDING) {
+        thread->wait_queue = NULL;
+    }
+
+    return (status);
+}
+
+
+
+static void mutex_own(
+    struct nmutex *             mutex,
+    struct nthread *            thread)
+{
+    mutex->owner = thread;
+    ndlist_add_before(&thread->mutex_held, &mutex->held_node);
+}
+
+
+
+/**@brief       Return the flags which satisfy a wait condition, or zero
+ */
+static uint32_t flags_match(
+    uint32_t                    flags,
+    uint32_t                    mask,
+    uint8_t                     mode)
+{
+    uint32_t                    matched;
+
+    matched = flags & mask;
+
+    if (((mode & NEVENT_FLAGS_ALL) != 0u) && (matched != mask)) {
+
+        return (0u);
+    }
+
+    return (matched);
+}
+
+
+
+/**@brief       Return the priority a resource owner is due
+ * @details     The highest of the priority the thread had before it took its
+ *              first resource and the raises of all resources it holds.
+ */
+static uint_fast8_t resource_priority(
+    const struct nthread *      thread)
+{
+    uint_fast8_t                priority;
+    const struct ndlist *       node;
+
+    priority = thread->own_priority;
+
+    for (node = ndlist_next(&thread->resource_held);
+         node != &thread->resource_held;
+         node = ndlist_next(node)) {
+        const struct nresource * resource = HELD_NODE_TO_RESOURCE(node);
+        uint_fast8_t            raise;
+
+        if (resource->protocol == NRESOURCE_CEILING) {
+            raise = resource->ceiling;
+        } else if (!nprio_queue_is_empty(&resource->wait_queue)) {
+            raise = nbias_list_get_bias(nprio_queue_peek(&resource->wait_queue));
+        } else {
+            raise = 0u;
+        }
+
+        if (priority < raise) {
+            priority = raise;
+        }
+    }
+
+    return (priority);
+}
+
+
+
+/**@brief       Bring the priority of a resource owner up to date
+ * @details     The owner gets the priority it is due, raised or lowered. An
+ *              owner which itself waits on another object is moved to its new
+ *              position in that wait queue. When that object is an inheritance
+ *              resource, its owner is updated, too, so the change follows the
+ *              whole chain of owners.
+ */
+static void resource_update(
+    struct nthread *            thread)
+{
+    while (thread != NULL) {
+        uint_fast8_t            priority;
+        struct nthread *        next;
+
+        priority = resource_priority(thread);
+#if (CONFIG_SCHED_EDF == 1)
+        NREQUIRE(NAPI_USAGE, priority != CONFIG_SCHED_EDF_PRIORITY);
+#endif
+
+        if (nsched_thread_get_priority_i(thread) == priority) {
+
+            return;
+        }
+        nsched_thread_set_priority_i(thread, priority);
+        next = NULL;
+
+        if ((thread->wait_queue  != NULL) &&
+            (thread->wait_status == NSYNC_PENDING)) {
+            nprio_queue_remove(thread->wait_queue, &thread->wait_node);
+            nbias_list_init(&thread->wait_node, priority);
+            nprio_queue_insert(thread->wait_queue, &thread->wait_node);
+
+            if (thread->wait_object == WAIT_RESOURCE) {
+                struct nresource * resource;
+
+                resource = CONTAINER_OF(thread->wait_queue, struct nresource,
+                    wait_queue);
+
+                if (resource->protocol == NRESOURCE_INHERIT) {
+                    next = resource->owner;                                     /* Pass the change down the chain     */
+                }
+            }
+        }
+        thread = next;
+    }
+}
+
+
+
+static void resource_acquire(
+    struct nresource *          resource,
+    struct nthread *            thread)
+{
+    if (ndlist_is_empty(&thread->resource_held)) {
+        thread->own_priority = nsched_thread_get_priority_i(thread);
+    }
+    ndlist_add_before(&thread->resource_held, &resource->held_node);
+    resource->owner = thread;
+    resource_update(thread);                                                    /* Ceiling or remaining waiters       */
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+
+
+void nsync_thread_init(
+    struct nthread *            thread)
+{
+    nbias_list_init(&thread->wait_node, nbias_list_get_bias(&thread->node));
+    ntimer_init(&thread->wait_timer);
+    ndlist_init(&thread->mutex_held);
+    ndlist_init(&thread->resource_held);
+    thread->own_priority = 0u;
+    thread->wait_queue   = NULL;
+    thread->wait_flags   = 0u;
+    thread->wait_mode    = 0u;
+    thread->wait_status  = NSYNC_ACQUIRED;
+    thread->wait_object  = WAIT_SEM;
+}
+
+
+
+void nsync_thread_term_i(
+    struct nthread *            thread)
+{
+    if (thread->wait_queue != NULL) {
+
+        if (thread->wait_status == NSYNC_PENDING) {
+            sync_unqueue(thread);
+            ntimer_cancel_i(&thread->wait_timer);
+        } else if (thread->wait_status == NSYNC_ACQUIRED) {                     /* Handed off, but not collected      */
+
+            switch (thread->wait_object) {
+                case WAIT_SEM: {
+                    nsem_post_i(CONTAINER_OF(thread->wait_queue, struct nsem,
+                        wait_queue));
+                    break;
+                }
+                case WAIT_FLAGS: {
+                    if ((thread->wait_mode & NEVENT_FLAGS_CONSUME) != 0u) {
+                        nevent_flags_set_i(CONTAINER_OF(thread->wait_queue,
+                            struct nevent_flags, wait_queue),
+                            thread->wait_flags);
+                    }
+                    break;
+                }
+                default: {                                                      /* Ownership is released below        */
+                    break;
+                }
+            }
+        }
+        thread->wait_queue = NULL;
+    }
+
+    while (!ndlist_is_empty(&thread->mutex_held)) {
+        nmutex_unlock_i(HELD_NODE_TO_MUTEX(ndlist_next(&thread->mutex_held)),
+            thread);
+    }
+
+    while (!ndlist_is_empty(&thread->resource_held)) {
+        nresource_unlock_i(
+            HELD_NODE_TO_RESOURCE(ndlist_next(&thread->resource_held)),
+            thread);
+    }
+}
+
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+void nsem_init(
+    struct nsem *               sem,
+    uint32_t                    count)
+{
+    NREQUIRE(NAPI_POINTER, sem != NULL);
+
+    nprio_queue_init(&sem->wait_queue);
+    sem->count = count;
+}
+
+
+
+int nsem_wait_i(
+    struct nsem *               sem,
+    struct nthread *            thread,
+    ncore_time_tick             timeout)
+{
+    NREQUIRE(NAPI_POINTER, sem != NULL);
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+    if (thread->wait_queue == &sem->wait_queue) {
+
+        return (sync_collect(thread));
+    }
+    NREQUIRE(NAPI_USAGE, thread->wait_queue == NULL);                           /* One object at a time               */
+
+    if (sem->count != 0u) {
+        sem->count--;
+
+        return (NSYNC_ACQUIRED);
+    }
+
+    if (timeout == NSYNC_NO_WAIT) {
+
+        return (NSYNC_TIMEOUT);
+    }
+    sync_park(&sem->wait_queue, thread, timeout, WAIT_SEM);
+
+    return (NSYNC_PENDING);
+}
+
+
+
+int nsem_wait(
+    struct nsem *               sem,
+    struct nthread *            thread,
+    ncore_time_tick             timeout)
+{
+    ncore_lock                  sys_lock;
+    int                         retval;
+
+    ncore_lock_enter(&sys_lock);
+    retval = nsem_wait_i(sem, thread, timeout);
+    ncore_lock_exit(&sys_lock);
+
+    return (retval);
+}
+
+
+
+void nsem_post_i(
+    struct nsem *               sem)
+{
+    NREQUIRE(NAPI_POINTER, sem != NULL);
+
+    if (!nprio_queue_is_empty(&sem->wait_queue)) {
+        struct nbias_list *     node;
+
+        node = nprio_queue_peek(&sem->wait_queue);
+        nprio_queue_remove(&sem->wait_queue, node);
+        sync_wake(WAIT_NODE_TO_THREAD(node), NSYNC_ACQUIRED);                   /* Hand off the unit to the waiter    */
+    } else {
+        NREQUIRE(NAPI_USAGE, sem->count != UINT32_MAX);
+        sem->count++;
+    }
+}
+
+
+
+void nsem_post(
+    struct nsem *               sem)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    nsem_post_i(sem);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void nmutex_init(
+    struct nmutex *             mutex)
+{
+    NREQUIRE(NAPI_POINTER, mutex != NULL);
+
+    nprio_queue_init(&mutex->wait_queue);
+    ndlist_init(&mutex->held_node);
+    mutex->owner = NULL;
+}
+
+
+
+int nmutex_lock_i(
+    struct nmutex *             mutex,
+    struct nthread *            thread,
+    ncore_time_tick             timeout)
+{
+    NREQUIRE(NAPI_POINTER, mutex != NULL);
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+    if (thread->wait_queue == &mutex->wait_queue) {
+
+        return (sync_collect(thread));
+    }
+    NREQUIRE(NAPI_USAGE, thread->wait_queue == NULL);
+    NREQUIRE(NAPI_USAGE, mutex->owner != thread);
+
+    if (mutex->owner == NULL) {
+        mutex_own(mutex, thread);
+
+        return (NSYNC_ACQUIRED);
+    }
+
+    if (timeout == NSYNC_NO_WAIT) {
+
+        return (NSYNC_TIMEOUT);
+    }
+    sync_park(&mutex->wait_queue, thread, timeout, WAIT_MUTEX);
+
+    return (NSYNC_PENDING);
+}
+
+
+
+int nmutex_lock(
+    struct nmutex *             mutex,
+    struct nthread *            thread,
+    ncore_time_tick             timeout)
+{
+    ncore_lock                  sys_lock;
+    int                         retval;
+
+    ncore_lock_enter(&sys_lock);
+    retval = nmutex_lock_i(mutex, thread, timeout);
+    ncore_lock_exit(&sys_lock);
+
+    return (retval);
+}
+
+
+
+void nmutex_unlock_i(
+    struct nmutex *             mutex,
+    struct nthread *            thread)
+{
+    NREQUIRE(NAPI_POINTER, mutex != NULL);
+    NREQUIRE(NAPI_USAGE,   mutex->owner == thread);
+
+    (void)thread;
+
+    ndlist_remove(&mutex->held_node);
+    ndlist_init(&mutex->held_node);
+
+    if (!nprio_queue_is_empty(&mutex->wait_queue)) {
+        struct nbias_list *     node;
+
+        node = nprio_queue_peek(&mutex->wait_queue);
+        nprio_queue_remove(&mutex->wait_queue, node);
+        mutex_own(mutex, WAIT_NODE_TO_THREAD(node));                            /* Hand off the ownership             */
+        sync_wake(mutex->owner, NSYNC_ACQUIRED);
+    } else {
+        mutex->owner = NULL;
+    }
+}
+
+
+
+void nmutex_unlock(
+    struct nmutex *             mutex,
+    struct nthread *            thread)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    nmutex_unlock_i(mutex, thread);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void nresource_init(
+    struct nresource *          resource,
+    uint8_t                     protocol,
+    uint_fast8_t                ceiling)
+{
+    NREQUIRE(NAPI_POINTER, resource != NULL);
+    NREQUIRE(NAPI_RANGE,   (protocol == NRESOURCE_INHERIT) ||
+                           (protocol == NRESOURCE_CEILING));
+    NREQUIRE(NAPI_RANGE,   ceiling <= NTHREAD_PRIORITY_MAX);
+#if (CONFIG_SCHED_EDF == 1)
+    NREQUIRE(NAPI_RANGE,   (protocol != NRESOURCE_CEILING) ||
+                           (ceiling != CONFIG_SCHED_EDF_PRIORITY));
+#endif
+
+    nprio_queue_init(&resource->wait_queue);
+    ndlist_init(&resource->held_node);
+    resource->owner    = NULL;
+    resource->ceiling  = ceiling;
+    resource->protocol = protocol;
+}
+
+
+
+int nresource_lock_i(
+    struct nresource *          resource,
+    struct nthread *            thread,
+    ncore_time_tick             timeout)
+{
+    NREQUIRE(NAPI_POINTER, resource != NULL);
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+
+    if (thread->wait_queue == &resource->wait_queue) {
+
+        return (sync_collect(thread));
+    }
+    NREQUIRE(NAPI_USAGE, thread->wait_queue == NULL);
+    NREQUIRE(NAPI_USAGE, resource->owner != thread);
+    NREQUIRE(NAPI_USAGE, (resource->protocol != NRESOURCE_CEILING) ||
+        (nsched_thread_get_priority_i(thread) <= resource->ceiling));
+#if (CONFIG_SCHED_EDF == 1)
+    NREQUIRE(NAPI_USAGE,
+        nsched_thread_get_priority_i(thread) != CONFIG_SCHED_EDF_PRIORITY);
+#endif
+
+    if (resource->owner == NULL) {
+        resource_acquire(resource, thread);
+
+        return (NSYNC_ACQUIRED);
+    }
+
+    if (timeout == NSYNC_NO_WAIT) {
+
+        return (NSYNC_TIMEOUT);
+    }
+    sync_park(&resource->wait_queue, thread, timeout, WAIT_RESOURCE);
+
+    if (resource->protocol == NRESOURCE_INHERIT) {
+        resource_update(resource->owner);
+    }
+
+    return (NSYNC_PENDING);
+}
+
+
+
+int nresource_lock(
+    struct nresource *          resource,
+    struct nthread *            thread,
+    ncore_time_tick             timeout)
+{
+    ncore_lock                  sys_lock;
+    int                         retval;
+
+    ncore_lock_enter(&sys_lock);
+    retval = nresource_lock_i(resource, thread, timeout);
+    ncore_lock_exit(&sys_lock);
+
+    return (retval);
+}
+
+
+
+void nresource_unlock_i(
+    struct nresource *          resource,
+    struct nthread *            thread)
+{
+    NREQUIRE(NAPI_POINTER, resource != NULL);
+    NREQUIRE(NAPI_USAGE,   resource->owner == thread);
+
+    ndlist_remove(&resource->held_node);
+    ndlist_init(&resource->held_node);
+    resource_update(thread);                                                    /* Keep raises of resources still held*/
+
+    if (!nprio_queue_is_empty(&resource->wait_queue)) {
+        struct nbias_list *     node;
+        struct nthread *        next;
+
+        node = nprio_queue_peek(&resource->wait_queue);
+        next = WAIT_NODE_TO_THREAD(node);
+        nprio_queue_remove(&resource->wait_queue, node);
+        sync_wake(next, NSYNC_ACQUIRED);
+        resource_acquire(resource, next);                                       /* Hand off, raising the new owner    */
+    } else {
+        resource->owner = NULL;
+    }
+}
+
+
+
+void nresource_unlock(
+    struct nresource *          resource,
+    struct nthread *            thread)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    nresource_unlock_i(resource, thread);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void nevent_flags_init(
+    struct nevent_flags *       event_flags)
+{
+    NREQUIRE(NAPI_POINTER, event_flags != NULL);
+
+    nprio_queue_init(&event_flags->wait_queue);
+    event_flags->flags = 0u;
+}
+
+
+
+int nevent_flags_wait_i(
+    struct nevent_flags *       event_flags,
+    struct nthread *            thread,
+    uint32_t                    mask,
+    uint8_t                     mode,
+    ncore_time_tick             timeout,
+    uint32_t *                  matched)
+{
+    uint32_t                    match;
+
+    NREQUIRE(NAPI_POINTER, event_flags != NULL);
+    NREQUIRE(NAPI_POINTER, thread != NULL);
+    NREQUIRE(NAPI_RANGE,   mask != 0u);
+
+    if (thread->wait_queue == &event_flags->wait_queue) {
+        int                     status;
+
+        status = sync_collect(thread);
+
+        if (matched != NULL) {
+            *matched = (status == NSYNC_ACQUIRED) ? thread->wait_flags : 0u;
+        }
+
+        return (status);
+    }
+    NREQUIRE(NAPI_USAGE, thread->wait_queue == NULL);
+
+    match = flags_match(event_flags->flags, mask, mode);
+
+    if (matched != NULL) {
+        *matched = match;
+    }
+
+    if (match != 0u) {
+
+        if ((mode & NEVENT_FLAGS_CONSUME) != 0u) {
+            event_flags->flags &= ~match;
+        }
+
+        return (NSYNC_ACQUIRED);
+    }
+
+    if (timeout == NSYNC_NO_WAIT) {
+
+        return (NSYNC_TIMEOUT);
+    }
+    thread->wait_flags = mask;
+    thread->wait_mode  = mode;
+    sync_park(&event_flags->wait_queue, thread, timeout, WAIT_FLAGS);
+
+    return (NSYNC_PENDING);
+}
+
+
+
+int nevent_flags_wait(
+    struct nevent_flags *       event_flags,
+    struct nthread *            thread,
+    uint32_t                    mask,
+    uint8_t                     mode,
+    ncore_time_tick             timeout,
+    uint32_t *                  matched)
+{
+    ncore_lock                  sys_lock;
+    int                         retval;
+
+    ncore_lock_enter(&sys_lock);
+    retval = nevent_flags_wait_i(event_flags, thread, mask, mode, timeout,
+        matched);
+    ncore_lock_exit(&sys_lock);
+
+    return (retval);
+}
+
+
+
+void nevent_flags_set_i(
+    struct nevent_flags *       event_flags,
+    uint32_t                    flags)
+{
+    struct nprio_queue          remaining;
+
+    NREQUIRE(NAPI_POINTER, event_flags != NULL);
+
+    event_flags->flags |= flags;
+    nprio_queue_init(&remaining);
+
+    /* Waiters are visited in priority order. Those which are not satisfied
+     * are moved to a new queue in the same order, so FIFO order within a
+     * priority level is kept.
+     */
+    while (!nprio_queue_is_empty(&event_flags->wait_queue)) {
+        struct nbias_list *     node;
+        struct nthread *        thread;
+        uint32_t                match;
+
+        node   = nprio_queue_peek(&event_flags->wait_queue);
+        thread = WAIT_NODE_TO_THREAD(node);
+        nprio_queue_remove(&event_flags->wait_queue, node);
+        match  = flags_match(event_flags->flags, thread->wait_flags,
+            thread->wait_mode);
+
+        if (match != 0u) {
+
+            if ((thread->wait_mode & NEVENT_FLAGS_CONSUME) != 0u) {
+                event_flags->flags &= ~match;
+            }
+            thread->wait_flags = match;
+            sync_wake(thread, NSYNC_ACQUIRED);
+        } else {
+            nprio_queue_insert(&remaining, node);
+        }
+    }
+    event_flags->wait_queue = remaining;
+}
+
+
+
+void nevent_flags_set(
+    struct nevent_flags *       event_flags,
+    uint32_t                    flags)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    nevent_flags_set_i(event_flags, flags);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+void nevent_flags_clear(
+    struct nevent_flags *       event_flags,
+    uint32_t                    flags)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(NAPI_POINTER, event_flags != NULL);
+
+    ncore_lock_enter(&sys_lock);
+    event_flags->flags &= ~flags;
+    ncore_lock_exit(&sys_lock);
+}
+
+#endif /* (CONFIG_SCHED_SYNC == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of sync.c
+ ******************************************************************************/
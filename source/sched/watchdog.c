@@ -0,0 +1,217 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Run budget watchdog implementation
+ * @addtogroup  sched_watchdog
+ *********************************************************************//** @{ */
+/**@defgroup    sched_watchdog_impl Implementation
+ * @brief       Run budget watchdog implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <string.h>
+
+#include "port/core.h"
+#include "shared/component.h"
+#include "shared/debug.h"
+#include "misc/timer.h"
+#include "sched/watchdog.h"
+
+#if (CONFIG_SCHED_WATCHDOG == 1)
+/*=========================================================  LOCAL MACRO's  ==*/
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+struct watchdog
+{
+    struct ntimer               timer;          /**<@brief Budget timer       */
+    struct nthread *            thread;         /**<@brief Watched thread     */
+    ncore_time_tick             expired_at;     /**<@brief Budget expiry tick */
+    ncore_time_tick             overrun;        /**<@brief Ticks over budget  */
+    bool                        is_armed;       /**<@brief Timer is for thread*/
+    bool                        is_overrun;     /**<@brief Budget expired     */
+    nwatchdog_policy *          policy;         /**<@brief Policy callback    */
+    void *                      policy_arg;
+    uint32_t                    overruns;       /**<@brief Total overruns     */
+    struct nwatchdog_offender   offender[CONFIG_SCHED_WATCHDOG_OFFENDERS];
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static const NCOMPONENT_DEFINE("Run Budget Watchdog", "Nenad Radulovic");
+
+static struct watchdog          g_watchdog;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+/**@brief       Budget timer callback
+ * @details     The timer is not cancelled when a thread returns, so it may
+ *              also expire while a thread without budget runs. Such expiry is
+ *              ignored.
+ */
+static void watchdog_expired(
+    void *                      arg)
+{
+    struct watchdog *           watchdog = arg;
+
+    if (watchdog->is_armed) {
+        watchdog->is_overrun = true;
+        watchdog->expired_at = ntimer_domain_default()->now;
+    }
+}
+
+
+
+static void watchdog_record_i(
+    struct watchdog *           watchdog,
+    const struct nthread *      thread)
+{
+    struct nwatchdog_offender * offender;
+
+    offender = &watchdog->offender[
+        watchdog->overruns % CONFIG_SCHED_WATCHDOG_OFFENDERS];
+    offender->thread  = thread;
+#if (CONFIG_REGISTRY == 1)
+    memcpy(offender->name, thread->name, sizeof(offender->name));
+#endif
+    offender->budget  = thread->budget;
+    offender->overrun = watchdog->overrun;
+    watchdog->overruns++;
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+
+
+bool nwatchdog_arm_i(
+    struct nthread *            thread)
+{
+    struct watchdog *           watchdog = &g_watchdog;
+
+    if (thread->budget == 0u) {
+
+        return (false);
+    }
+    watchdog->thread     = thread;
+    watchdog->is_armed   = true;
+    watchdog->is_overrun = false;
+
+    if (ntimer_is_running_i(&watchdog->timer)) {                                /* Usually just pushes the expiry     */
+        ntimer_restart_i(&watchdog->timer, thread->budget);                     /* later without touching the queue.  */
+    } else {
+        ntimer_start_i(&watchdog->timer, thread->budget, watchdog_expired,
+            watchdog, NTIMER_ATTR_ONE_SHOT);
+    }
+
+    return (true);
+}
+
+
+
+bool nwatchdog_disarm_i(
+    struct nthread *            thread)
+{
+    struct watchdog *           watchdog = &g_watchdog;
+
+    NREQUIRE(NAPI_USAGE, watchdog->thread == thread);
+
+    watchdog->thread   = NULL;
+    watchdog->is_armed = false;
+
+    if (watchdog->is_overrun) {
+        watchdog->overrun = ntimer_domain_default()->now - watchdog->expired_at;
+        watchdog_record_i(watchdog, thread);
+    }
+
+    return (watchdog->is_overrun);
+}
+
+
+
+void nwatchdog_report(
+    struct nthread *            thread)
+{
+    struct watchdog *           watchdog = &g_watchdog;
+
+    if (watchdog->policy != NULL) {
+        watchdog->policy(thread, watchdog->overrun, watchdog->policy_arg);
+    }
+}
+
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+void nwatchdog_init(
+    nwatchdog_policy *          policy,
+    void *                      arg)
+{
+    struct watchdog *           watchdog = &g_watchdog;
+
+    memset(watchdog, 0, sizeof(*watchdog));
+    ntimer_init(&watchdog->timer);
+    watchdog->policy     = policy;
+    watchdog->policy_arg = arg;
+}
+
+
+
+size_t nwatchdog_offenders(
+    struct nwatchdog_offender * offender,
+    size_t                      size)
+{
+    struct watchdog *           watchdog = &g_watchdog;
+    ncore_lock                  sys_lock;
+    uint32_t                    index;
+    size_t                      count;
+
+    NREQUIRE(NAPI_POINTER, offender != NULL);
+
+    count = 0u;
+    ncore_lock_enter(&sys_lock);
+    index = watchdog->overruns;
+
+    while ((count < size) && (index != 0u) &&
+           ((watchdog->overruns - index) < CONFIG_SCHED_WATCHDOG_OFFENDERS)) {
+        index--;
+        offender[count++] =
+            watchdog->offender[index % CONFIG_SCHED_WATCHDOG_OFFENDERS];
+    }
+    ncore_lock_exit(&sys_lock);
+
+    return (count);
+}
+
+
+
+uint32_t nwatchdog_overruns(void)
+{
+    return (g_watchdog.overruns);
+}
+
+#endif /* (CONFIG_SCHED_WATCHDOG == 1) */
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of watchdog.c
+ ******************************************************************************/
@@ -0,0 +1,292 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Trace dump to Chrome/Perfetto JSON converter
+ * @details     Host tool which reads a binary dump written by ntrace_dump()
+ *              and writes JSON in Chrome trace event format. The output can
+ *              be opened in ui.perfetto.dev or chrome://tracing.
+ *
+ *              Usage: trace2json <dump file> [<json file>]
+ *********************************************************************//** @{ */
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define TRACE_MAGIC                     0x4e545243u
+#define TRACE_VERSION                   1u
+
+#define TRACE_THREAD_INSERT             1u
+#define TRACE_THREAD_REMOVE             2u
+#define TRACE_THREAD_DISPATCH           3u
+#define TRACE_SCHED_IDLE                4u
+#define TRACE_TIMER_FIRE                5u
+#define TRACE_MEM_ALLOC                 6u
+#define TRACE_MEM_FREE                  7u
+
+#define PID_SCHED                       1
+#define PID_TIMER                       2
+#define PID_MEM                         3
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/* Layout must match struct ntrace_header and struct ntrace_event */
+struct trace_header
+{
+    uint32_t                    magic;
+    uint16_t                    version;
+    uint16_t                    event_size;
+    uint32_t                    count;
+    uint32_t                    stamp_freq;
+};
+
+struct trace_event
+{
+    uint32_t                    stamp;
+    uint32_t                    object;
+    uint32_t                    arg;
+    uint16_t                    type;
+    uint16_t                    reserved;
+};
+
+struct trace_ctx
+{
+    FILE *                      out;
+    double                      us_per_tick;
+    uint64_t                    time;           /* Stamp extended to 64 bits  */
+    uint32_t                    last_stamp;
+    int                         is_seeded;      /* last_stamp holds a stamp   */
+    int                         running;        /* Dispatched span is open    */
+    uint32_t                    running_thread;
+    uint32_t                    running_priority;
+    uint64_t                    running_since;
+    int                         first;
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static void emit_separator(
+    struct trace_ctx *          ctx)
+{
+    fputs(ctx->first ? "\n  " : ",\n  ", ctx->out);
+    ctx->first = 0;
+}
+
+
+
+static void emit_process_name(
+    struct trace_ctx *          ctx,
+    int                         pid,
+    const char *                name)
+{
+    emit_separator(ctx);
+    fprintf(ctx->out,
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+        "\"args\":{\"name\":\"%s\"}}", pid, name);
+}
+
+
+
+static void emit_instant(
+    struct trace_ctx *          ctx,
+    int                         pid,
+    const char *                name,
+    const struct trace_event *  event,
+    const char *                arg_name)
+{
+    emit_separator(ctx);
+    fprintf(ctx->out,
+        "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,"
+        "\"tid\":%u", name, (double)ctx->time * ctx->us_per_tick, pid,
+        (unsigned)event->object);
+
+    if (arg_name != NULL) {
+        fprintf(ctx->out, ",\"args\":{\"%s\":%u}", arg_name,
+            (unsigned)event->arg);
+    }
+    fputs("}", ctx->out);
+}
+
+
+
+static void close_span(
+    struct trace_ctx *          ctx)
+{
+    if (!ctx->running) {
+        return;
+    }
+    emit_separator(ctx);
+    fprintf(ctx->out,
+        "{\"name\":\"thread 0x%08x\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+        "\"pid\":%d,\"tid\":%u,\"args\":{\"priority\":%u}}",
+        (unsigned)ctx->running_thread,
+        (double)ctx->running_since * ctx->us_per_tick,
+        (double)(ctx->time - ctx->running_since) * ctx->us_per_tick,
+        PID_SCHED, (unsigned)ctx->running_thread,
+        (unsigned)ctx->running_priority);
+    ctx->running = 0;
+}
+
+
+
+static void convert_event(
+    struct trace_ctx *          ctx,
+    const struct trace_event *  event)
+{
+    if ((event->type < TRACE_THREAD_INSERT) || (event->type > TRACE_MEM_FREE)) {
+        return;                                                                 /* Lost events carry a newer stamp    */
+    }
+
+    if (!ctx->is_seeded) {                                                      /* Time starts at first valid event   */
+        ctx->is_seeded  = 1;
+        ctx->last_stamp = event->stamp;
+    }
+    ctx->time      += (uint32_t)(event->stamp - ctx->last_stamp);
+    ctx->last_stamp = event->stamp;
+
+    switch (event->type) {
+        case TRACE_THREAD_INSERT: {
+            emit_instant(ctx, PID_SCHED, "insert", event, "priority");
+            break;
+        }
+        case TRACE_THREAD_REMOVE: {
+            emit_instant(ctx, PID_SCHED, "remove", event, "priority");
+            break;
+        }
+        case TRACE_THREAD_DISPATCH: {
+            close_span(ctx);
+            ctx->running          = 1;
+            ctx->running_thread   = event->object;
+            ctx->running_priority = event->arg;
+            ctx->running_since    = ctx->time;
+            break;
+        }
+        case TRACE_SCHED_IDLE: {
+            close_span(ctx);
+            break;
+        }
+        case TRACE_TIMER_FIRE: {
+            emit_instant(ctx, PID_TIMER, "fire", event, NULL);
+            break;
+        }
+        case TRACE_MEM_ALLOC: {
+            emit_instant(ctx, PID_MEM, "alloc", event, "size");
+            break;
+        }
+        case TRACE_MEM_FREE: {
+            emit_instant(ctx, PID_MEM, "free", event, NULL);
+            break;
+        }
+        default : {
+            break;
+        }
+    }
+}
+
+/*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
+/*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
+
+
+int main(
+    int                         argc,
+    char **                     argv)
+{
+    struct trace_header         header;
+    struct trace_event          event;
+    struct trace_ctx            ctx;
+    FILE *                      in;
+    uint32_t                    count;
+
+    if ((argc < 2) || (argc > 3)) {
+        fprintf(stderr, "Usage: %s <dump file> [<json file>]\n", argv[0]);
+
+        return (2);
+    }
+    in = fopen(argv[1], "rb");
+
+    if (in == NULL) {
+        perror(argv[1]);
+
+        return (1);
+    }
+
+    if ((fread(&header, sizeof(header), 1, in) != 1) ||
+        (header.magic != TRACE_MAGIC) ||
+        (header.version != TRACE_VERSION) ||
+        (header.event_size != sizeof(event)) ||
+        (header.stamp_freq == 0u)) {
+        fprintf(stderr, "%s: not a trace dump\n", argv[1]);
+        fclose(in);
+
+        return (1);
+    }
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.out         = stdout;
+    ctx.us_per_tick = 1000000.0 / (double)header.stamp_freq;
+    ctx.first       = 1;
+
+    if (argc == 3) {
+        ctx.out = fopen(argv[2], "w");
+
+        if (ctx.out == NULL) {
+            perror(argv[2]);
+            fclose(in);
+
+            return (1);
+        }
+    }
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", ctx.out);
+    emit_process_name(&ctx, PID_SCHED, "Scheduler");
+    emit_process_name(&ctx, PID_TIMER, "Virtual timers");
+    emit_process_name(&ctx, PID_MEM,   "Memory");
+
+    for (count = 0u; count < header.count; count++) {
+
+        if (fread(&event, sizeof(event), 1, in) != 1) {
+            fprintf(stderr, "%s: truncated dump\n", argv[1]);
+            break;
+        }
+        convert_event(&ctx, &event);
+    }
+    close_span(&ctx);
+    fputs("\n]}\n", ctx.out);
+    fclose(in);
+
+    if (ctx.out != stdout) {
+        fclose(ctx.out);
+    }
+
+    return (0);
+}
+
+/** @} *//*********************************************************************
+ * END of trace2json.c
+ ******************************************************************************/